@@ -0,0 +1,71 @@
+#include "bench_timer.h"
+#if BENCH_TIMER_HAVE_TSC
+#include <cpuid.h>
+#endif
+
+#define CALIBRATION_NS 50000000ULL // 50 мс
+#define OVERHEAD_SAMPLES 100000
+
+TimerSource timer_source = TIMER_CLOCK;
+double timer_ns_per_tick = 1.0;
+uint64_t timer_overhead_ticks = 0;
+
+#if BENCH_TIMER_HAVE_TSC
+// Инвариантный TSC идет с постоянной частотой независимо от P/C-состояний
+static int tsc_invariant(void) {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return 0;
+    return (edx >> 8) & 1;
+}
+
+// Частота TSC по интервалу CLOCK_MONOTONIC
+static double tsc_calibrate(void) {
+    uint64_t clock_start = clock_now_ns();
+    uint64_t tsc_start = __rdtsc();
+    uint64_t clock_end;
+    do {
+        clock_end = clock_now_ns();
+    } while (clock_end - clock_start < CALIBRATION_NS);
+    uint64_t tsc_end = __rdtsc();
+    return (double)(clock_end - clock_start) / (double)(tsc_end - tsc_start);
+}
+#endif
+
+int timer_init(TimerSource source) {
+    int result = 0;
+    timer_source = TIMER_CLOCK;
+    timer_ns_per_tick = 1.0;
+    timer_overhead_ticks = 0;
+
+    if (source == TIMER_TSC) {
+#if BENCH_TIMER_HAVE_TSC
+        if (tsc_invariant()) {
+            timer_ns_per_tick = tsc_calibrate();
+            timer_source = TIMER_TSC;
+        } else {
+            result = -1;
+        }
+#else
+        result = -1;
+#endif
+    }
+
+    // Минимум пустого замера: вычитается из каждого результата, поэтому
+    // берется минимум, а не среднее — так время операции не занижается
+    uint64_t overhead = UINT64_MAX;
+    for (int i = 0; i < OVERHEAD_SAMPLES; ++i) {
+        uint64_t start = timer_start();
+        uint64_t stop = timer_stop();
+        if (stop - start < overhead) overhead = stop - start;
+    }
+    timer_overhead_ticks = overhead;
+    return result;
+}
+
+double timer_overhead_ns(void) {
+    return (double)timer_overhead_ticks * timer_ns_per_tick;
+}
+
+const char* timer_source_name(void) {
+    return timer_source == TIMER_TSC ? "tsc" : "clock";
+}
@@ -0,0 +1,91 @@
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TIMER_HAVE_TSC 1
+#else
+#define BENCH_TIMER_HAVE_TSC 0
+#endif
+
+// Источник отметок времени для замеров
+typedef enum {
+    TIMER_CLOCK, // clock_gettime(CLOCK_MONOTONIC), отметки в наносекундах
+    TIMER_TSC    // rdtsc/rdtscp, отметки в тактах TSC
+} TimerSource;
+
+extern TimerSource timer_source;
+extern double timer_ns_per_tick;
+extern uint64_t timer_overhead_ticks;
+
+/**
+ * @brief Выбирает источник времени и измеряет накладные расходы замера.
+ *
+ * Для TIMER_TSC проверяется инвариантный TSC и частота калибруется по
+ * CLOCK_MONOTONIC. Затем измеряется минимальная длительность пустого
+ * замера timer_start/timer_stop — она вычитается из каждого результата.
+ *
+ * @param source Желаемый источник времени.
+ * @return 0 при успехе, -1 если TSC недоступен (используется TIMER_CLOCK).
+ */
+int timer_init(TimerSource source);
+
+/**
+ * @brief Возвращает накладные расходы одного замера в наносекундах.
+ */
+double timer_overhead_ns(void);
+
+/**
+ * @brief Возвращает имя текущего источника времени ("clock" или "tsc").
+ */
+const char* timer_source_name(void);
+
+static inline uint64_t clock_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Начало замера: lfence не дает rdtsc выполниться раньше предыдущих инструкций
+static inline uint64_t timer_start(void) {
+#if BENCH_TIMER_HAVE_TSC
+    if (timer_source == TIMER_TSC) {
+        _mm_lfence();
+        return __rdtsc();
+    }
+#endif
+    return clock_now_ns();
+}
+
+// Конец замера: rdtscp ждет завершения измеряемого кода,
+// lfence не дает последующим инструкциям начаться раньше чтения
+static inline uint64_t timer_stop(void) {
+#if BENCH_TIMER_HAVE_TSC
+    if (timer_source == TIMER_TSC) {
+        unsigned aux;
+        uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+    }
+#endif
+    return clock_now_ns();
+}
+
+/**
+ * @brief Переводит разность отметок в наносекунды за вычетом накладных расходов замера.
+ *
+ * @param start Отметка timer_start.
+ * @param stop Отметка timer_stop.
+ * @return Длительность в наносекундах (не меньше 0).
+ */
+static inline uint64_t timer_elapsed_ns(uint64_t start, uint64_t stop) {
+    uint64_t ticks = stop - start;
+    ticks = ticks > timer_overhead_ticks ? ticks - timer_overhead_ticks : 0;
+    if (timer_source == TIMER_CLOCK) return ticks;
+    return (uint64_t)((double)ticks * timer_ns_per_tick + 0.5);
+}
+
+#endif // BENCH_TIMER_H
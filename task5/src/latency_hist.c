@@ -0,0 +1,47 @@
+#include "latency_hist.h"
+#include <string.h>
+
+void hist_init(LatencyHist* hist) {
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT64_MAX;
+}
+
+// Наибольшее значение, попадающее в интервал index
+static uint64_t bucket_upper(int index) {
+    if (index < HIST_SUB_COUNT) return (uint64_t)index;
+    int shift = (index - HIST_SUB_COUNT) / HIST_HALF_COUNT + 1;
+    uint64_t sub = (uint64_t)((index - HIST_SUB_COUNT) % HIST_HALF_COUNT + HIST_HALF_COUNT);
+    return ((sub + 1) << shift) - 1;
+}
+
+uint64_t hist_percentile(const LatencyHist* hist, double percentile) {
+    if (hist->count == 0) return 0;
+    // Ранг — число значений, не превышающих искомое (не меньше одного)
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)hist->count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > hist->count) rank = hist->count;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+double hist_mean(const LatencyHist* hist) {
+    return hist->count ? (double)hist->sum / (double)hist->count : 0.0;
+}
+
+void hist_merge(LatencyHist* dst, const LatencyHist* src) {
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
@@ -0,0 +1,91 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+// Число бит субинтервала: каждая октава делится на 2^(HIST_SUB_BITS-1)
+// равных частей, относительная погрешность не хуже 1/64
+#define HIST_SUB_BITS 7
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_HALF_COUNT (HIST_SUB_COUNT / 2)
+
+// Наибольшее представимое значение — 2^HIST_MAX_BITS - 1 нс (около 18 минут),
+// большие значения попадают в последний интервал
+#define HIST_MAX_BITS 40
+#define HIST_BUCKETS (HIST_SUB_COUNT + (HIST_MAX_BITS - HIST_SUB_BITS) * HIST_HALF_COUNT)
+
+/**
+ * @brief Лог-линейная гистограмма задержек (в стиле HdrHistogram).
+ *
+ * Значения до HIST_SUB_COUNT хранятся точно, дальше каждая октава
+ * делится на HIST_HALF_COUNT интервалов. Вся память лежит внутри
+ * структуры, поэтому запись значения не выделяет память и занимает
+ * несколько инструкций.
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+    uint64_t buckets[HIST_BUCKETS];
+} LatencyHist;
+
+/**
+ * @brief Обнуляет гистограмму.
+ *
+ * @param hist Указатель на гистограмму.
+ */
+void hist_init(LatencyHist* hist);
+
+// Индекс интервала для значения value
+static inline int hist_bucket_index(uint64_t value) {
+    if (value < HIST_SUB_COUNT) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+    int shift = msb - (HIST_SUB_BITS - 1);
+    return HIST_SUB_COUNT + (shift - 1) * HIST_HALF_COUNT + (int)(value >> shift) - HIST_HALF_COUNT;
+}
+
+/**
+ * @brief Добавляет одно значение в гистограмму.
+ *
+ * @param hist Указатель на гистограмму.
+ * @param value Значение (обычно задержка в наносекундах).
+ */
+static inline void hist_record(LatencyHist* hist, uint64_t value) {
+    hist->buckets[hist_bucket_index(value)]++;
+    hist->count++;
+    hist->sum += value;
+    if (value < hist->min) hist->min = value;
+    if (value > hist->max) hist->max = value;
+}
+
+/**
+ * @brief Возвращает значение перцентиля.
+ *
+ * Результат — верхняя граница интервала, в который попал перцентиль,
+ * но не больше максимального записанного значения.
+ *
+ * @param hist Указатель на гистограмму.
+ * @param percentile Перцентиль в процентах (например, 99.9).
+ * @return Значение перцентиля или 0 для пустой гистограммы.
+ */
+uint64_t hist_percentile(const LatencyHist* hist, double percentile);
+
+/**
+ * @brief Возвращает среднее значение.
+ *
+ * @param hist Указатель на гистограмму.
+ * @return Среднее или 0 для пустой гистограммы.
+ */
+double hist_mean(const LatencyHist* hist);
+
+/**
+ * @brief Добавляет содержимое гистограммы src к dst.
+ *
+ * @param dst Гистограмма-приемник.
+ * @param src Гистограмма-источник.
+ */
+void hist_merge(LatencyHist* dst, const LatencyHist* src);
+
+#endif // LATENCY_HIST_H
@@ -1,77 +1,990 @@
 #include "mempool.h"
+#include "prefault.h"
+#include "numa.h"
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include <sys/mman.h>
+#include <linux/mman.h>
 
 // Узел в связном списке свободных блоков
 typedef struct Node {
     struct Node* next;
 } Node;
 
+// Узел индексного списка (POOL_FLAG_INDEX_LIST): номер следующего
+// свободного блока + 1, 0 — конец списка
+typedef struct {
+    uint32_t next;
+} IndexNode;
+
+// Счетчики статистики. В потокобезопасном режиме у каждого потока свой
+// набор в его ThreadCache: владелец пишет их без атомарных RMW-операций,
+// а pool_stats суммирует их relaxed-чтением
+typedef struct {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t failed;
+    uint64_t ops; // Счетчик операций для выборки замеров задержки
+    uint64_t alloc_hist[POOL_STATS_BUCKETS];
+    uint64_t free_hist[POOL_STATS_BUCKETS];
+} StatCounters;
+
+// Кэш блоков одного потока. Выровнен по кэш-линии, чтобы кэши
+// соседних потоков не делили одну линию (false sharing)
+typedef struct {
+    size_t count;
+    Node* blocks[POOL_CACHE_SIZE];
+    StatCounters stats;
+} __attribute__((aligned(64))) ThreadCache;
+
+// Голова общего lock-free стека: в младших 32 битах индекс блока + 1
+// (0 — стек пуст), в старших 32 битах — тег версии против ABA
+#define HEAD_INDEX(h) ((uint32_t)(h))
+#define HEAD_TAG(h) ((uint32_t)((h) >> 32))
+#define MAKE_HEAD(idx, tag) (((uint64_t)(tag) << 32) | (uint64_t)(idx))
+
+// Сколько блоков переносится между кэшем потока и общим стеком за раз
+#define CACHE_BATCH (POOL_CACHE_SIZE / 2)
+
+#ifdef MEMPOOL_DEBUG
+#define POOL_CANARY 0xC0DEC0DEFEEDFACEULL
+#define POOL_POISON 0xDD
+#endif
+
+// Откуда взята память арены
+typedef enum {
+    ARENA_MALLOC,
+    ARENA_MMAP,
+    ARENA_EXTERNAL,
+    ARENA_RESERVED // Зарезервированный диапазон, фиксируемый порциями (растущий пул)
+} ArenaSource;
+
 // Структура, описывающая пул
 struct MemoryPool {
     size_t block_size;
-    Node* free_list_head; 
-    void* memory_start;    
+    Node* free_list_head;
+    int index_list;      // Звенья списка — IndexNode, а не Node
+    void* memory_start;
     size_t memory_total_size;
+    size_t block_count;
+
+    // Статистика: в однопоточном режиме — здесь, в потокобезопасном —
+    // здесь только для потоков сверх POOL_MAX_THREADS (атомарно)
+    int latency_stats;
+    size_t high_water;
+    StatCounters stats;
+
+    // Арена: malloc (по умолчанию), mmap (POOL_FLAG_HUGEPAGES) или внешняя память
+    size_t arena_size;
+    ArenaSource arena_source;
+    PoolPageKind page_kind;
+    int locked;
+    int prefaulted;
+    int prefault_threads;
+    int numa_node; // -1 — арена не привязана к узлу
+
+    // Растущий пул: memory_total_size, block_count и arena_size (фиксированная
+    // часть диапазона) увеличивает фоновый поток, читаются они атомарно
+    int growable;
+    int mlock_required;
+    size_t reserved_size;   // Весь зарезервированный диапазон адресов
+    size_t commit_granule;  // Фиксация идет целыми страницами (4 КБ или 2 МБ)
+    size_t max_block_count;
+    size_t grow_watermark;
+    size_t grow_chunk;
+    pthread_t grower;
+    atomic_int grower_stop;
+    _Atomic(Node*) pending_head; // Новые блоки для однопоточного списка
+
+    // Потокобезопасный режим (caches == NULL в однопоточном режиме)
+    int block_shift;               // log2(block_size), если это степень двойки, иначе -1
+    ThreadCache* caches;           // POOL_MAX_THREADS кэшей, по одному на поток
+    _Alignas(64) _Atomic uint64_t shared_head;
+    _Atomic size_t shared_taken;      // Блоков вне общего стека (выделены или в кэшах)
+    _Atomic size_t shared_taken_peak; // Максимум shared_taken
+
+#ifdef MEMPOOL_DEBUG
+    size_t user_size;    // Полезный размер блока (до канарейки)
+    size_t node_size;    // Байт в начале свободного блока, занятых звеном списка
+    uint64_t* allocated; // Битовая карта выделенных блоков
+#endif
 };
 
+// Номер слота потока, общий для всех пулов. Слоты учитываются битовой
+// маской и освобождаются при завершении потока, так что новый поток
+// наследует кэш завершившегося вместе с лежащими в нем блоками
+_Static_assert(POOL_MAX_THREADS == 64, "used_slots is a 64-bit mask");
+static _Atomic uint64_t used_slots;
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+static __thread int thread_slot = -1;
+
+static void release_slot(void* value) {
+    int slot = (int)(intptr_t)value - 1;
+    atomic_fetch_and(&used_slots, ~(1ULL << slot));
+}
+
+static void create_slot_key(void) {
+    pthread_key_create(&slot_key, release_slot);
+}
+
+static int claim_slot(void) {
+    pthread_once(&slot_key_once, create_slot_key);
+    uint64_t used = atomic_load(&used_slots);
+    int slot;
+    do {
+        if (used == UINT64_MAX) return POOL_MAX_THREADS;
+        slot = __builtin_ctzll(~used);
+    } while (!atomic_compare_exchange_weak(&used_slots, &used, used | (1ULL << slot)));
+    pthread_setspecific(slot_key, (void*)(intptr_t)(slot + 1));
+    return slot;
+}
+
+static ThreadCache* current_cache(MemoryPool* pool) {
+    if (thread_slot < 0) {
+        thread_slot = claim_slot();
+    }
+    // Потоки сверх лимита работают напрямую с общим стеком
+    if (thread_slot >= POOL_MAX_THREADS) return NULL;
+    return &pool->caches[thread_slot];
+}
+
+static uint32_t block_index(const MemoryPool* pool, const Node* node) {
+    size_t offset = (size_t)((const char*)node - (const char*)pool->memory_start);
+    if (pool->block_shift >= 0) return (uint32_t)(offset >> pool->block_shift);
+    return (uint32_t)(offset / pool->block_size);
+}
+
+static Node* block_at(const MemoryPool* pool, uint32_t index) {
+    return (Node*)((char*)pool->memory_start + (size_t)index * pool->block_size);
+}
+
+static int owns_block(const MemoryPool* pool, const Node* node) {
+    const char* p = (const char*)node;
+    const char* start = (const char*)pool->memory_start;
+    return p >= start && p < start + __atomic_load_n(&pool->memory_total_size, __ATOMIC_ACQUIRE);
+}
+
+#ifdef MEMPOOL_DEBUG
+static void debug_fail(const MemoryPool* pool, const void* block, const char* what) {
+    fprintf(stderr, "mempool: %s (pool %p, block %p)\n", what, (const void*)pool, block);
+    abort();
+}
+
+// Разметить блок как свободный: яд после звена списка и канарейка после полезной части
+static void debug_poison(const MemoryPool* pool, Node* node) {
+    char* p = (char*)node;
+    memset(p + pool->node_size, POOL_POISON, pool->user_size - pool->node_size);
+    uint64_t canary = POOL_CANARY;
+    memcpy(p + pool->user_size, &canary, sizeof(canary));
+}
+
+static size_t debug_check_pointer(const MemoryPool* pool, const Node* node) {
+    size_t offset = (size_t)((const char*)node - (const char*)pool->memory_start);
+    if (!owns_block(pool, node) || offset % pool->block_size != 0) {
+        debug_fail(pool, node, "pointer does not belong to this pool");
+    }
+    return offset / pool->block_size;
+}
+
+static void debug_on_alloc(MemoryPool* pool, Node* node) {
+    size_t index = debug_check_pointer(pool, node);
+    uint64_t bit = 1ULL << (index % 64);
+    if (__atomic_fetch_or(&pool->allocated[index / 64], bit, __ATOMIC_RELAXED) & bit) {
+        debug_fail(pool, node, "free list corrupted: block is already allocated");
+    }
+    const unsigned char* p = (const unsigned char*)node;
+    for (size_t i = pool->node_size; i < pool->user_size; ++i) {
+        if (p[i] != POOL_POISON) {
+            debug_fail(pool, node, "block was written after it had been freed");
+        }
+    }
+}
+
+static void debug_on_free(MemoryPool* pool, Node* node) {
+    size_t index = debug_check_pointer(pool, node);
+    uint64_t bit = 1ULL << (index % 64);
+    if (!(__atomic_fetch_and(&pool->allocated[index / 64], ~bit, __ATOMIC_RELAXED) & bit)) {
+        debug_fail(pool, node, "double free");
+    }
+    uint64_t canary;
+    memcpy(&canary, (const char*)node + pool->user_size, sizeof(canary));
+    if (canary != POOL_CANARY) {
+        debug_fail(pool, node, "guard canary overwritten: write past the end of the block");
+    }
+    debug_poison(pool, node);
+}
+
+#define POOL_CHECK_ALLOC(pool, node) debug_on_alloc((pool), (node))
+#define POOL_CHECK_FREE(pool, node) debug_on_free((pool), (node))
+#else
+#define POOL_CHECK_ALLOC(pool, node) ((void)0)
+#define POOL_CHECK_FREE(pool, node) ((void)0)
+#endif
+
+// Звенья однопоточного списка свободных блоков
+static inline Node* list_next(const MemoryPool* pool, Node* node) {
+    if (!pool->index_list) return node->next;
+    uint32_t next = ((IndexNode*)node)->next;
+    return next ? block_at(pool, next - 1) : NULL;
+}
+
+static inline void list_link(const MemoryPool* pool, Node* node, Node* next) {
+    if (!pool->index_list) {
+        node->next = next;
+        return;
+    }
+    ((IndexNode*)node)->next = next ? block_index(pool, next) + 1 : 0;
+}
+
+// Снять с общего стека до max блоков одной CAS-операцией.
+// Пока тег головы не изменился, цепочка под ней тоже не менялась,
+// поэтому успешный CAS гарантирует целостность прочитанной цепочки
+static size_t shared_pop(MemoryPool* pool, Node** out, size_t max) {
+    uint64_t head = atomic_load_explicit(&pool->shared_head, memory_order_acquire);
+    for (;;) {
+        uint32_t index = HEAD_INDEX(head);
+        if (index == 0) return 0;
+
+        size_t n = 0;
+        Node* node = block_at(pool, index - 1);
+        Node* next;
+        for (;;) {
+            out[n++] = node;
+            next = __atomic_load_n(&node->next, __ATOMIC_RELAXED);
+            // Блок мог быть выделен другим потоком и перезаписан данными —
+            // тогда next мусорный, разыменовывать его нельзя (CAS все равно не пройдет)
+            if (n == max || !next || !owns_block(pool, next)) break;
+            node = next;
+        }
+
+        uint32_t next_index = (next && owns_block(pool, next)) ? block_index(pool, next) + 1 : 0;
+        uint64_t new_head = MAKE_HEAD(next_index, HEAD_TAG(head) + 1);
+        if (atomic_compare_exchange_weak_explicit(&pool->shared_head, &head, new_head,
+                                                  memory_order_acquire, memory_order_acquire)) {
+            size_t taken = atomic_fetch_add_explicit(&pool->shared_taken, n, memory_order_relaxed) + n;
+            size_t peak = atomic_load_explicit(&pool->shared_taken_peak, memory_order_relaxed);
+            while (taken > peak &&
+                   !atomic_compare_exchange_weak_explicit(&pool->shared_taken_peak, &peak, taken,
+                                                          memory_order_relaxed, memory_order_relaxed)) {
+            }
+            return n;
+        }
+    }
+}
+
+// Положить в общий стек цепочку first..last из count блоков, уже связанную через next
+static void shared_push(MemoryPool* pool, Node* first, Node* last, size_t count) {
+    uint32_t first_index = block_index(pool, first) + 1;
+    uint64_t head = atomic_load_explicit(&pool->shared_head, memory_order_relaxed);
+    uint64_t new_head;
+    do {
+        uint32_t index = HEAD_INDEX(head);
+        __atomic_store_n(&last->next, index ? block_at(pool, index - 1) : NULL, __ATOMIC_RELAXED);
+        new_head = MAKE_HEAD(first_index, HEAD_TAG(head) + 1);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->shared_head, &head, new_head,
+                                                    memory_order_release, memory_order_relaxed));
+    atomic_fetch_sub_explicit(&pool->shared_taken, count, memory_order_relaxed);
+}
+
+// Вернуть count блоков с вершины кэша в общий стек
+static void cache_flush(MemoryPool* pool, ThreadCache* cache, size_t count) {
+    if (count == 0) return;
+    size_t first = cache->count - count;
+    for (size_t i = first; i + 1 < cache->count; ++i) {
+        cache->blocks[i]->next = cache->blocks[i + 1];
+    }
+    shared_push(pool, cache->blocks[first], cache->blocks[cache->count - 1], count);
+    cache->count = first;
+}
+
+// Анонимное отображение size байт с началом, выровненным по align:
+// отображается с запасом, лишние края снимаются
+static void* map_aligned(size_t size, size_t align, int prot, int extra_flags) {
+    size_t reserve = size + align;
+    char* raw = mmap(NULL, reserve, prot, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* aligned = (char*)(((uintptr_t)raw + align - 1) & ~(uintptr_t)(align - 1));
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    size_t tail = (size_t)((raw + reserve) - (aligned + size));
+    if (tail > 0) munmap(aligned + size, tail);
+    return aligned;
+}
+
+// Отобразить арену на 2 МБ страницах. Сначала пробуются явные hugepages
+// (нужен vm.nr_hugepages > 0), затем обычное отображение, выровненное
+// по 2 МБ, с подсказкой ядру собрать его из THP
+static int arena_map_hugepages(MemoryPool* pool) {
+    size_t size = (pool->memory_total_size + POOL_HUGEPAGE_SIZE - 1) & ~(POOL_HUGEPAGE_SIZE - 1);
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if (p != MAP_FAILED) {
+        pool->page_kind = POOL_PAGES_HUGETLB;
+    } else {
+        p = map_aligned(size, POOL_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, 0);
+        if (!p) return -1;
+        madvise(p, size, MADV_HUGEPAGE);
+        pool->page_kind = POOL_PAGES_THP;
+    }
+    pool->memory_start = p;
+    pool->arena_size = size;
+    pool->arena_source = ARENA_MMAP;
+    return 0;
+}
+
+// Зарезервировать диапазон адресов под max_block_count блоков без выделения
+// памяти (PROT_NONE) и зафиксировать из него первые committed байт
+static int arena_reserve(MemoryPool* pool, size_t alignment, size_t committed, unsigned flags) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    pool->commit_granule = (flags & POOL_FLAG_HUGEPAGES) ? POOL_HUGEPAGE_SIZE : page_size;
+    size_t granule = pool->commit_granule;
+    pool->reserved_size = (pool->max_block_count * pool->block_size + granule - 1) & ~(granule - 1);
+    committed = (committed + granule - 1) & ~(granule - 1);
+
+    size_t align = alignment > granule ? alignment : granule;
+    void* p = map_aligned(pool->reserved_size, align, PROT_NONE, MAP_NORESERVE);
+    if (!p) return -1;
+    if (flags & POOL_FLAG_HUGEPAGES) {
+        madvise(p, pool->reserved_size, MADV_HUGEPAGE);
+        pool->page_kind = POOL_PAGES_THP;
+    }
+    if (committed > 0 && mprotect(p, committed, PROT_READ | PROT_WRITE) != 0) {
+        munmap(p, pool->reserved_size);
+        return -1;
+    }
+    pool->memory_start = p;
+    pool->arena_size = committed;
+    pool->arena_source = ARENA_RESERVED;
+    return 0;
+}
+
+static void arena_release(MemoryPool* pool) {
+    if (pool->locked) munlock(pool->memory_start, pool->arena_size);
+    if (pool->arena_source == ARENA_MMAP) {
+        munmap(pool->memory_start, pool->arena_size);
+    } else if (pool->arena_source == ARENA_RESERVED) {
+        munmap(pool->memory_start, pool->reserved_size);
+    } else if (pool->arena_source == ARENA_MALLOC) {
+        free(pool->memory_start);
+    }
+}
+
+// Затронуть каждую страницу диапазона записью, чтобы все page faults
+// произошли при создании (или росте) пула, а не в горячем пути pool_alloc
+static void arena_prefault_range(MemoryPool* pool, char* start, size_t size) {
+    PrefaultOptions options = { .threads = pool->prefault_threads, .numa_node = pool->numa_node };
+    prefault_range(start, size, &options, NULL);
+}
+
+static void arena_prefault(MemoryPool* pool) {
+    arena_prefault_range(pool, (char*)pool->memory_start, pool->arena_size);
+    pool->prefaulted = 1;
+}
+
+// Освободить саму структуру пула вместе со служебными данными проверок
+static void pool_release_struct(MemoryPool* pool) {
+#ifdef MEMPOOL_DEBUG
+    free(pool->allocated);
+#endif
+    free(pool);
+}
+
+// Добавить в пул следующую порцию блоков. Вызывается только потоком роста:
+// память фиксируется, прогревается и блокируется до того, как блоки
+// станут видны в списке свободных
+static int pool_grow(MemoryPool* pool) {
+    size_t count = pool->block_count;
+    if (count >= pool->max_block_count) return -1;
+    size_t add = pool->max_block_count - count;
+    if (add > pool->grow_chunk) add = pool->grow_chunk;
+    size_t new_total = (count + add) * pool->block_size;
+
+    if (new_total > pool->arena_size) {
+        size_t granule = pool->commit_granule;
+        size_t target = (new_total + granule - 1) & ~(granule - 1);
+        if (target > pool->reserved_size) target = pool->reserved_size;
+        char* start = (char*)pool->memory_start + pool->arena_size;
+        size_t len = target - pool->arena_size;
+        if (mprotect(start, len, PROT_READ | PROT_WRITE) != 0) return -1;
+        // Прогрев до mlock: mlock сам загружает страницы в одном потоке,
+        // и после него параллельному прогреву нечего делать
+        arena_prefault_range(pool, start, len);
+        if (mlock(start, len) != 0) {
+            if (pool->mlock_required) {
+                mprotect(start, len, PROT_NONE);
+                return -1;
+            }
+            pool->locked = 0;
+        }
+        __atomic_store_n(&pool->arena_size, target, __ATOMIC_RELEASE);
+    }
+
+    Node* first = (Node*)((char*)pool->memory_start + count * pool->block_size);
+    Node* last = first;
+    for (size_t i = 0; i < add; ++i) {
+        last = (Node*)((char*)first + i * pool->block_size);
+        Node* next_node = i + 1 < add ? (Node*)((char*)last + pool->block_size) : NULL;
+        list_link(pool, last, next_node);
+#ifdef MEMPOOL_DEBUG
+        debug_poison(pool, last);
+#endif
+    }
+    __atomic_store_n(&pool->memory_total_size, new_total, __ATOMIC_RELEASE);
+    __atomic_store_n(&pool->block_count, count + add, __ATOMIC_RELEASE);
+
+    if (pool->caches) {
+        atomic_fetch_add_explicit(&pool->shared_taken, add, memory_order_relaxed);
+        shared_push(pool, first, last, add);
+    } else {
+        // Однопоточный список принадлежит потоку-владельцу, поэтому новые
+        // блоки откладываются в pending_head, откуда их забирает pool_alloc
+        Node* pending = atomic_load_explicit(&pool->pending_head, memory_order_relaxed);
+        do {
+            list_link(pool, last, pending);
+        } while (!atomic_compare_exchange_weak_explicit(&pool->pending_head, &pending, first,
+                                                        memory_order_release, memory_order_relaxed));
+    }
+    return 0;
+}
+
+// Оценка числа свободных блоков. В потокобезопасном режиме блоки в кэшах
+// потоков считаются занятыми, поэтому пул растет с запасом
+static size_t pool_free_estimate(MemoryPool* pool) {
+    size_t count = pool->block_count;
+    uint64_t taken;
+    if (pool->caches) {
+        taken = atomic_load_explicit(&pool->shared_taken, memory_order_relaxed);
+    } else {
+        taken = __atomic_load_n(&pool->stats.allocs, __ATOMIC_RELAXED) -
+                __atomic_load_n(&pool->stats.frees, __ATOMIC_RELAXED);
+    }
+    return taken < count ? count - (size_t)taken : 0;
+}
+
+// Фоновый поток роста: периодически проверяет запас свободных блоков
+static void* grower_func(void* arg) {
+    MemoryPool* pool = (MemoryPool*)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load_explicit(&pool->grower_stop, memory_order_relaxed)) {
+        next.tv_nsec += POOL_GROW_POLL_US * 1000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        while (pool_free_estimate(pool) < pool->grow_watermark && pool_grow(pool) == 0) {
+        }
+    }
+    return NULL;
+}
+
+// Забрать блоки, добавленные потоком роста (однопоточный режим)
+static inline Node* take_pending(MemoryPool* pool) {
+    if (!pool->growable) return NULL;
+    return atomic_exchange_explicit(&pool->pending_head, NULL, memory_order_acquire);
+}
+
 MemoryPool* pool_create(size_t block_size, size_t block_count) {
-    // Размер блока должен быть достаточным, чтобы вместить указатель Node
-    if (block_size < sizeof(Node)) {
-        block_size = sizeof(Node);
+    return pool_create_ex(block_size, block_count, NULL);
+}
+
+MemoryPool* pool_create_ex(size_t block_size, size_t block_count, const PoolOptions* options) {
+    unsigned flags = options ? options->flags : 0;
+    size_t alignment = options ? options->alignment : 0;
+    // Индексный список используется только в однопоточном режиме
+    int index_list = (flags & POOL_FLAG_INDEX_LIST) && !(flags & POOL_FLAG_THREAD_SAFE);
+    size_t node_size = index_list ? sizeof(IndexNode) : sizeof(Node);
+
+    // Размер блока должен быть достаточным, чтобы вместить звено списка
+    if (block_size < node_size) {
+        block_size = node_size;
+    }
+#ifdef MEMPOOL_DEBUG
+    // Канарейка лежит сразу за полезной частью, выровненной по 8 байт
+    size_t user_size = (block_size + 7) & ~(size_t)7;
+    block_size = user_size + POOL_GUARD_SIZE;
+#endif
+
+    // Блоки потокобезопасного пула расходятся по разным потокам, поэтому
+    // по умолчанию каждый занимает целое число кэш-линий
+    if (alignment == 0) {
+        alignment = (flags & POOL_FLAG_THREAD_SAFE) ? POOL_ALIGN_CACHE_LINE : node_size;
+    } else if (alignment == POOL_ALIGN_PAGE) {
+        alignment = (size_t)sysconf(_SC_PAGESIZE);
+    }
+    if (alignment < node_size || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    block_size = (block_size + alignment - 1) & ~(alignment - 1);
+    size_t max_block_count = options ? options->max_block_count : 0;
+    int growable = max_block_count > block_count;
+    if (!growable) max_block_count = block_count;
+    if (growable && options->arena) {
+        errno = EINVAL;
+        return NULL;
+    }
+    // Индекс блока в голове общего стека и в индексном списке занимает 32 бита
+    if ((flags & (POOL_FLAG_THREAD_SAFE | POOL_FLAG_INDEX_LIST)) && max_block_count >= UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
     }
 
     // Выделить память для самой структуры пула
-    MemoryPool* pool = (MemoryPool*)malloc(sizeof(MemoryPool));
+    MemoryPool* pool = (MemoryPool*)aligned_alloc(_Alignof(MemoryPool), sizeof(MemoryPool));
     if (!pool) return NULL;
 
     pool->block_size = block_size;
+    pool->index_list = index_list;
     pool->memory_total_size = block_size * block_count;
-
-    // Выделить один большой кусок памяти для всех блоков
-    pool->memory_start = malloc(pool->memory_total_size);
-    if (!pool->memory_start) {
+    pool->block_count = block_count;
+    pool->latency_stats = (flags & POOL_FLAG_LATENCY_STATS) != 0;
+    pool->growable = growable;
+    pool->mlock_required = (flags & POOL_FLAG_MLOCK_REQUIRED) != 0;
+    pool->max_block_count = max_block_count;
+    pool->grow_watermark = options && options->grow_watermark ? options->grow_watermark : block_count / 4;
+    pool->grow_chunk = options && options->grow_chunk ? options->grow_chunk : block_count;
+    if (pool->grow_chunk == 0) pool->grow_chunk = 1;
+    atomic_init(&pool->grower_stop, 0);
+    atomic_init(&pool->pending_head, NULL);
+    pool->high_water = 0;
+    memset(&pool->stats, 0, sizeof(pool->stats));
+    atomic_init(&pool->shared_taken, 0);
+    atomic_init(&pool->shared_taken_peak, 0);
+#ifdef MEMPOOL_DEBUG
+    pool->user_size = user_size;
+    pool->node_size = node_size;
+    pool->allocated = (uint64_t*)calloc((max_block_count + 63) / 64 + 1, sizeof(uint64_t));
+    if (!pool->allocated) {
         free(pool);
         return NULL;
     }
+#endif
+    pool->caches = NULL;
+    pool->block_shift = -1;
+    if ((block_size & (block_size - 1)) == 0) {
+        pool->block_shift = __builtin_ctzl(block_size);
+    }
+
+    pool->arena_source = ARENA_MALLOC;
+    pool->page_kind = POOL_PAGES_DEFAULT;
+    pool->locked = 0;
+    pool->prefaulted = 0;
+    pool->prefault_threads = options ? options->prefault_threads : 0;
+    pool->numa_node = -1;
+
+    // Выделить один большой кусок памяти для всех блоков
+    if (options && options->arena) {
+        if (options->arena_size < pool->memory_total_size ||
+            ((uintptr_t)options->arena & (alignment - 1)) != 0) {
+            pool_release_struct(pool);
+            errno = EINVAL;
+            return NULL;
+        }
+        pool->memory_start = options->arena;
+        pool->arena_size = pool->memory_total_size;
+        pool->arena_source = ARENA_EXTERNAL;
+    } else if (growable) {
+        if (arena_reserve(pool, alignment, pool->memory_total_size, flags) != 0) {
+            pool_release_struct(pool);
+            return NULL;
+        }
+    } else if (flags & POOL_FLAG_HUGEPAGES) {
+        if (arena_map_hugepages(pool) != 0) {
+            pool_release_struct(pool);
+            return NULL;
+        }
+    } else if (flags & POOL_FLAG_NUMA_BIND) {
+        // Политика mbind задается для целых страниц, поэтому арена
+        // не должна делить страницы с другими данными из malloc
+        size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+        pool->arena_size = (pool->memory_total_size + page_size - 1) & ~(page_size - 1);
+        pool->memory_start = map_aligned(pool->arena_size, alignment > page_size ? alignment : page_size,
+                                         PROT_READ | PROT_WRITE, 0);
+        if (!pool->memory_start) {
+            pool_release_struct(pool);
+            return NULL;
+        }
+        pool->arena_source = ARENA_MMAP;
+    } else {
+        // aligned_alloc требует размер, кратный выравниванию; шаг блоков уже кратен ему
+        pool->arena_size = pool->memory_total_size;
+        pool->memory_start = aligned_alloc(alignment, pool->memory_total_size);
+        if (!pool->memory_start) {
+            pool_release_struct(pool);
+            return NULL;
+        }
+    }
+
+    // Привязать арену к узлу до прогрева и mlock: страницы выделяются
+    // при первом обращении, и политика должна действовать уже тогда
+    if ((flags & POOL_FLAG_NUMA_BIND) && pool->arena_source != ARENA_EXTERNAL) {
+        size_t bind_size = pool->arena_source == ARENA_RESERVED ? pool->reserved_size : pool->arena_size;
+        if (numa_bind_range(pool->memory_start, bind_size, options->numa_node) != 0) {
+            int saved_errno = errno;
+            perror("pool_create: mbind failed");
+            arena_release(pool);
+            pool_release_struct(pool);
+            errno = saved_errno;
+            return NULL;
+        }
+        pool->numa_node = options->numa_node;
+    }
+
+    // Прогреть арену до mlock: mlock загружает еще не тронутые страницы
+    // сам, в одном потоке, и параллельный прогрев после него ничего не делает
+    if (flags & POOL_FLAG_PREFAULT) {
+        arena_prefault(pool);
+    }
 
     // Заблокировать выделенную память в RAM
-    mlock(pool->memory_start, pool->memory_total_size);
+    if (mlock(pool->memory_start, pool->arena_size) == 0) {
+        pool->locked = 1;
+    } else {
+        int saved_errno = errno;
+        perror("pool_create: mlock failed (check RLIMIT_MEMLOCK or run with sudo)");
+        if (flags & POOL_FLAG_MLOCK_REQUIRED) {
+            arena_release(pool);
+            pool_release_struct(pool);
+            errno = saved_errno;
+            return NULL;
+        }
+    }
 
-    // Разметить память как связный список свободных блоков
-    pool->free_list_head = NULL;
+    // Разметить память как связный список свободных блоков по возрастанию адресов
+    pool->free_list_head = block_count ? (Node*)pool->memory_start : NULL;
     for (size_t i = 0; i < block_count; ++i) {
         Node* current_node = (Node*)((char*)pool->memory_start + i * block_size);
-        current_node->next = pool->free_list_head;
-        pool->free_list_head = current_node;
+        Node* next_node = i + 1 < block_count ? (Node*)((char*)current_node + block_size) : NULL;
+        list_link(pool, current_node, next_node);
+#ifdef MEMPOOL_DEBUG
+        debug_poison(pool, current_node);
+#endif
+    }
+
+    if (flags & POOL_FLAG_THREAD_SAFE) {
+        pool->caches = (ThreadCache*)aligned_alloc(_Alignof(ThreadCache),
+                                                   POOL_MAX_THREADS * sizeof(ThreadCache));
+        if (!pool->caches) {
+            arena_release(pool);
+            pool_release_struct(pool);
+            return NULL;
+        }
+        memset(pool->caches, 0, POOL_MAX_THREADS * sizeof(ThreadCache));
+        // Весь размеченный список становится содержимым общего стека
+        uint32_t index = pool->free_list_head ? block_index(pool, pool->free_list_head) + 1 : 0;
+        atomic_init(&pool->shared_head, MAKE_HEAD(index, 0));
+        pool->free_list_head = NULL;
+    }
+
+    if (growable && pthread_create(&pool->grower, NULL, grower_func, pool) != 0) {
+        free(pool->caches);
+        arena_release(pool);
+        pool_release_struct(pool);
+        return NULL;
     }
 
     return pool;
 }
 
+static Node* pool_alloc_mt(MemoryPool* pool, ThreadCache* cache) {
+    if (!cache) {
+        Node* node;
+        return shared_pop(pool, &node, 1) ? node : NULL;
+    }
+    if (cache->count == 0) {
+        size_t n = shared_pop(pool, cache->blocks, CACHE_BATCH);
+        if (n == 0) return NULL;
+        // Кэш раздается с вершины: разворачиваем цепочку, чтобы блоки
+        // выдавались в порядке списка (по возрастанию адресов)
+        for (size_t i = 0; i < n / 2; ++i) {
+            Node* tmp = cache->blocks[i];
+            cache->blocks[i] = cache->blocks[n - 1 - i];
+            cache->blocks[n - 1 - i] = tmp;
+        }
+        cache->count = n;
+    }
+    return cache->blocks[--cache->count];
+}
+
+static void pool_free_mt(MemoryPool* pool, ThreadCache* cache, Node* node) {
+    if (!cache) {
+        shared_push(pool, node, node, 1);
+        return;
+    }
+    // Переполненный кэш отдает половину блоков другим потокам
+    if (cache->count == POOL_CACHE_SIZE) {
+        cache_flush(pool, cache, CACHE_BATCH);
+    }
+    cache->blocks[cache->count++] = node;
+}
+
+// Счетчики текущего потока: собственные в кэше потока либо общие в пуле.
+// shared = 1, если общие счетчики обновляются несколькими потоками
+static inline StatCounters* thread_stats(MemoryPool* pool, ThreadCache* cache, int* shared) {
+    *shared = pool->caches != NULL && cache == NULL;
+    return cache ? &cache->stats : &pool->stats;
+}
+
+static inline void stat_add(uint64_t* counter, uint64_t n, int shared) {
+    if (shared) {
+        __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(counter, *counter + n, __ATOMIC_RELAXED);
+    }
+}
+
+// Замеряется каждая POOL_STATS_SAMPLE_PERIOD-я операция
+static inline int stat_sample(const MemoryPool* pool, StatCounters* stats, int shared) {
+    if (!pool->latency_stats) return 0;
+    uint64_t op = stats->ops;
+    stat_add(&stats->ops, 1, shared);
+    return op % POOL_STATS_SAMPLE_PERIOD == 0;
+}
+
+static void stat_record_latency(uint64_t* hist, const struct timespec* start, int shared) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long ns = (end.tv_sec - start->tv_sec) * 1000000000LL + (end.tv_nsec - start->tv_nsec);
+    int bucket = 63 - __builtin_clzll((unsigned long long)ns | 1);
+    if (bucket >= POOL_STATS_BUCKETS) bucket = POOL_STATS_BUCKETS - 1;
+    stat_add(&hist[bucket], 1, shared);
+}
+
 void* pool_alloc(MemoryPool* pool) {
-    // Извлечь первый свободный блок из списка
-    if (!pool || !pool->free_list_head) {
+    if (!pool) return NULL;
+    ThreadCache* cache = pool->caches ? current_cache(pool) : NULL;
+    int shared;
+    StatCounters* stats = thread_stats(pool, cache, &shared);
+    struct timespec start;
+    int sampled = stat_sample(pool, stats, shared);
+    if (sampled) clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Node* block_to_alloc;
+    if (pool->caches) {
+        block_to_alloc = pool_alloc_mt(pool, cache);
+    } else {
+        // Извлечь первый свободный блок из списка
+        block_to_alloc = pool->free_list_head;
+        if (!block_to_alloc) block_to_alloc = take_pending(pool);
+        if (block_to_alloc) pool->free_list_head = list_next(pool, block_to_alloc);
+    }
+
+    if (sampled) stat_record_latency(stats->alloc_hist, &start, shared);
+    if (!block_to_alloc) {
+        stat_add(&stats->failed, 1, shared);
         return NULL;
     }
-    Node* block_to_alloc = pool->free_list_head;
-    pool->free_list_head = block_to_alloc->next;
+    POOL_CHECK_ALLOC(pool, block_to_alloc);
+    stat_add(&stats->allocs, 1, shared);
+    if (!pool->caches) {
+        size_t in_use = (size_t)(stats->allocs - stats->frees);
+        if (in_use > pool->high_water) pool->high_water = in_use;
+    }
     return (void*)block_to_alloc;
 }
 
 void pool_free(MemoryPool* pool, void* block) {
     if (!pool || !block) return;
 
-    // Вернуть блок в начало списка свободных блоков
     Node* node_to_free = (Node*)block;
-    node_to_free->next = pool->free_list_head;
-    pool->free_list_head = node_to_free;
+    POOL_CHECK_FREE(pool, node_to_free);
+    ThreadCache* cache = pool->caches ? current_cache(pool) : NULL;
+    int shared;
+    StatCounters* stats = thread_stats(pool, cache, &shared);
+    struct timespec start;
+    int sampled = stat_sample(pool, stats, shared);
+    if (sampled) clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (pool->caches) {
+        pool_free_mt(pool, cache, node_to_free);
+    } else {
+        // Вернуть блок в начало списка свободных блоков
+        list_link(pool, node_to_free, pool->free_list_head);
+        pool->free_list_head = node_to_free;
+    }
+
+    if (sampled) stat_record_latency(stats->free_hist, &start, shared);
+    stat_add(&stats->frees, 1, shared);
+}
+
+static size_t pool_alloc_bulk_mt(MemoryPool* pool, ThreadCache* cache, void** ptrs, size_t count) {
+    size_t n = 0;
+    if (cache) {
+        while (n < count && cache->count > 0) {
+            ptrs[n++] = cache->blocks[--cache->count];
+        }
+    }
+    // Остаток снимается с общего стека цепочками по одной CAS-операции
+    Node* batch[POOL_CACHE_SIZE];
+    while (n < count) {
+        size_t want = count - n < POOL_CACHE_SIZE ? count - n : POOL_CACHE_SIZE;
+        size_t got = shared_pop(pool, batch, want);
+        if (got == 0) break;
+        for (size_t i = 0; i < got; ++i) {
+            ptrs[n++] = batch[i];
+        }
+    }
+    return n;
+}
+
+static void pool_free_bulk_mt(MemoryPool* pool, ThreadCache* cache, void** ptrs, size_t count) {
+    size_t i = 0;
+    if (cache) {
+        for (; i < count && cache->count < POOL_CACHE_SIZE; ++i) {
+            if (ptrs[i]) cache->blocks[cache->count++] = (Node*)ptrs[i];
+        }
+    }
+    // Не поместившиеся в кэш блоки уходят в общий стек одной цепочкой
+    Node* first = NULL;
+    Node* last = NULL;
+    size_t chain = 0;
+    for (; i < count; ++i) {
+        Node* node = (Node*)ptrs[i];
+        if (!node) continue;
+        if (last) last->next = node; else first = node;
+        last = node;
+        ++chain;
+    }
+    if (first) shared_push(pool, first, last, chain);
+}
+
+size_t pool_alloc_bulk(MemoryPool* pool, void** ptrs, size_t count) {
+    if (!pool || !ptrs) return 0;
+    ThreadCache* cache = pool->caches ? current_cache(pool) : NULL;
+    int shared;
+    StatCounters* stats = thread_stats(pool, cache, &shared);
+
+    size_t n = 0;
+    if (pool->caches) {
+        n = pool_alloc_bulk_mt(pool, cache, ptrs, count);
+    } else {
+        // Пройти count звеньев от головы и отрезать их от списка разом
+        Node* node = pool->free_list_head;
+        while (n < count) {
+            if (!node && !(node = take_pending(pool))) break;
+            ptrs[n++] = node;
+            node = list_next(pool, node);
+        }
+        pool->free_list_head = node;
+    }
+#ifdef MEMPOOL_DEBUG
+    for (size_t i = 0; i < n; ++i) debug_on_alloc(pool, (Node*)ptrs[i]);
+#endif
+
+    if (n < count) stat_add(&stats->failed, 1, shared);
+    stat_add(&stats->allocs, n, shared);
+    if (!pool->caches) {
+        size_t in_use = (size_t)(stats->allocs - stats->frees);
+        if (in_use > pool->high_water) pool->high_water = in_use;
+    }
+    return n;
+}
+
+void pool_free_bulk(MemoryPool* pool, void** ptrs, size_t count) {
+    if (!pool || !ptrs) return;
+#ifdef MEMPOOL_DEBUG
+    for (size_t i = 0; i < count; ++i) {
+        if (ptrs[i]) debug_on_free(pool, (Node*)ptrs[i]);
+    }
+#endif
+    ThreadCache* cache = pool->caches ? current_cache(pool) : NULL;
+    int shared;
+    StatCounters* stats = thread_stats(pool, cache, &shared);
+
+    size_t freed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (ptrs[i]) ++freed;
+    }
+    stat_add(&stats->frees, freed, shared);
+
+    if (pool->caches) {
+        pool_free_bulk_mt(pool, cache, ptrs, count);
+        return;
+    }
+
+    // Связать блоки в цепочку в порядке массива и пришить ее к голове списка
+    Node* first = NULL;
+    Node* last = NULL;
+    for (size_t i = 0; i < count; ++i) {
+        Node* node = (Node*)ptrs[i];
+        if (!node) continue;
+        if (last) list_link(pool, last, node); else first = node;
+        last = node;
+    }
+    if (!first) return;
+    list_link(pool, last, pool->free_list_head);
+    pool->free_list_head = first;
+}
+
+void pool_thread_flush(MemoryPool* pool) {
+    if (!pool || !pool->caches) return;
+    ThreadCache* cache = current_cache(pool);
+    if (cache) cache_flush(pool, cache, cache->count);
+}
+
+size_t pool_block_size(const MemoryPool* pool) {
+    return pool ? pool->block_size : 0;
+}
+
+static void stats_accumulate(PoolStats* out, const StatCounters* in) {
+    out->alloc_count += __atomic_load_n(&in->allocs, __ATOMIC_RELAXED);
+    out->free_count += __atomic_load_n(&in->frees, __ATOMIC_RELAXED);
+    out->failed_allocs += __atomic_load_n(&in->failed, __ATOMIC_RELAXED);
+    for (int i = 0; i < POOL_STATS_BUCKETS; ++i) {
+        out->alloc_latency_hist[i] += __atomic_load_n(&in->alloc_hist[i], __ATOMIC_RELAXED);
+        out->free_latency_hist[i] += __atomic_load_n(&in->free_hist[i], __ATOMIC_RELAXED);
+    }
+}
+
+void pool_stats(const MemoryPool* pool, PoolStats* stats) {
+    if (!pool || !stats) return;
+    memset(stats, 0, sizeof(*stats));
+    size_t block_count = __atomic_load_n(&pool->block_count, __ATOMIC_ACQUIRE);
+    stats->block_count = block_count;
+
+    stats_accumulate(stats, &pool->stats);
+    if (pool->caches) {
+        for (int i = 0; i < POOL_MAX_THREADS; ++i) {
+            stats_accumulate(stats, &pool->caches[i].stats);
+        }
+        stats->high_water = atomic_load_explicit(&pool->shared_taken_peak, memory_order_relaxed);
+    } else {
+        stats->high_water = pool->high_water;
+    }
+    // Счетчики разных потоков читаются не одновременно, поэтому разность
+    // может ненадолго выйти за пределы [0, block_count]
+    uint64_t in_use = stats->alloc_count > stats->free_count ? stats->alloc_count - stats->free_count : 0;
+    stats->in_use = in_use < block_count ? (size_t)in_use : block_count;
+}
+
+void pool_arena_info(const MemoryPool* pool, PoolArenaInfo* info) {
+    if (!pool || !info) return;
+    info->page_kind = pool->page_kind;
+    info->arena_size = __atomic_load_n(&pool->arena_size, __ATOMIC_ACQUIRE);
+    info->locked = pool->locked;
+    info->prefaulted = pool->prefaulted;
+    info->numa_node = pool->numa_node;
 }
 
 void pool_destroy(MemoryPool* pool) {
     if (!pool) return;
+    if (pool->growable) {
+        atomic_store(&pool->grower_stop, 1);
+        pthread_join(pool->grower, NULL);
+    }
     // Разблокировать и освободить всю память
-    munlock(pool->memory_start, pool->memory_total_size);
-    free(pool->memory_start);
-    free(pool);
+    arena_release(pool);
+    free(pool->caches);
+    pool_release_struct(pool);
 }
@@ -2,9 +2,97 @@
 #define MEMPOOL_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct MemoryPool MemoryPool;
 
+// Флаги режима работы пула (поле PoolOptions.flags)
+#define POOL_FLAG_THREAD_SAFE    (1u << 0) // Потокобезопасный режим: per-thread кэши + lock-free стек
+#define POOL_FLAG_HUGEPAGES      (1u << 1) // Арена на 2 МБ страницах (hugetlb, иначе THP через madvise)
+#define POOL_FLAG_PREFAULT       (1u << 2) // Заранее затронуть каждую страницу арены при создании
+#define POOL_FLAG_MLOCK_REQUIRED (1u << 3) // Не создавать пул, если mlock не удался
+#define POOL_FLAG_INDEX_LIST     (1u << 4) // Список свободных блоков на 32-битных индексах вместо указателей
+#define POOL_FLAG_LATENCY_STATS  (1u << 5) // Выборочно замерять задержку alloc/free для pool_stats
+#define POOL_FLAG_NUMA_BIND      (1u << 6) // Разместить арену на узле PoolOptions.numa_node (mbind)
+
+#define POOL_HUGEPAGE_SIZE (2UL * 1024 * 1024)
+
+// Период, с которым фоновый поток роста проверяет запас свободных блоков
+#define POOL_GROW_POLL_US 200
+
+// Гистограмма задержек в pool_stats: корзина i — задержки [2^i, 2^(i+1)) нс
+#define POOL_STATS_BUCKETS 32
+#define POOL_STATS_SAMPLE_PERIOD 64 // Замеряется каждая 64-я операция потока
+
+// Проверяемая сборка (-DMEMPOOL_DEBUG): битовая карта выделенных блоков,
+// проверка принадлежности указателя арене, канарейка после каждого блока
+// и заполнение освобожденных блоков ядом. Любое нарушение (двойное
+// освобождение, чужой указатель, выход за границу блока, запись после
+// освобождения) сообщается в stderr и завершает процесс через abort().
+// В обычной сборке все проверки исключаются на этапе компиляции.
+#ifdef MEMPOOL_DEBUG
+#define POOL_GUARD_SIZE 8 // Байт канарейки, добавляемых к каждому блоку
+#else
+#define POOL_GUARD_SIZE 0
+#endif
+
+// Предопределенные значения PoolOptions.alignment
+#define POOL_ALIGN_CACHE_LINE 64          // Блок не делит кэш-линию с соседями
+#define POOL_ALIGN_PAGE       ((size_t)-1) // Каждый блок начинается с новой страницы
+
+// Параметры потокобезопасного режима
+#define POOL_MAX_THREADS 64  // Число потоков, получающих собственный кэш блоков
+#define POOL_CACHE_SIZE  32  // Емкость кэша одного потока (в блоках)
+
+/**
+ * @brief Дополнительные параметры создания пула.
+ */
+typedef struct {
+    unsigned flags;       // Комбинация флагов POOL_FLAG_*
+    void* arena;          // Готовая память под блоки (NULL — пул выделяет ее сам)
+    size_t arena_size;    // Размер памяти arena в байтах
+    size_t alignment;     // Выравнивание блоков и начала арены (степень двойки, 0 — по умолчанию)
+    int prefault_threads; // Потоков прогрева арены при POOL_FLAG_PREFAULT (0 — автоматически)
+    int numa_node;        // Узел NUMA для POOL_FLAG_NUMA_BIND
+
+    // Рост пула: включается, если max_block_count больше block_count
+    size_t max_block_count; // Предел роста в блоках (под него сразу резервируются адреса)
+    size_t grow_watermark;  // Порог свободных блоков, ниже которого пул растет (0 — block_count / 4)
+    size_t grow_chunk;      // Сколько блоков добавляется за шаг роста (0 — block_count)
+} PoolOptions;
+
+// Тип страниц, на которых фактически размещена арена пула
+typedef enum {
+    POOL_PAGES_DEFAULT, // Обычные страницы (4 КБ)
+    POOL_PAGES_HUGETLB, // Явные hugepages (MAP_HUGETLB)
+    POOL_PAGES_THP      // Transparent Huge Pages (MADV_HUGEPAGE)
+} PoolPageKind;
+
+/**
+ * @brief Сведения об арене пула, определяемые при создании.
+ */
+typedef struct {
+    PoolPageKind page_kind; // На каких страницах размещена арена
+    size_t arena_size;      // Размер арены в байтах (с учетом округления под hugepages)
+    int locked;             // 1, если mlock арены успешен
+    int prefaulted;         // 1, если страницы арены затронуты при создании
+    int numa_node;          // Узел, к которому привязана арена (-1 — не привязана)
+} PoolArenaInfo;
+
+/**
+ * @brief Статистика использования пула.
+ */
+typedef struct {
+    size_t block_count;      // Всего блоков в пуле
+    size_t in_use;           // Выделено в данный момент
+    size_t high_water;       // Максимум одновременно занятых блоков (см. pool_stats)
+    uint64_t alloc_count;    // Успешных выделений
+    uint64_t free_count;     // Освобождений
+    uint64_t failed_allocs;  // Выделений, завершившихся NULL (пул пуст)
+    uint64_t alloc_latency_hist[POOL_STATS_BUCKETS]; // Выборочные задержки pool_alloc
+    uint64_t free_latency_hist[POOL_STATS_BUCKETS];  // Выборочные задержки pool_free
+} PoolStats;
+
 /**
  * @brief Создает пул памяти.
  * 
@@ -14,6 +102,58 @@ typedef struct MemoryPool MemoryPool;
  */
 MemoryPool* pool_create(size_t block_size, size_t block_count);
 
+/**
+ * @brief Создает пул памяти с дополнительными параметрами.
+ * 
+ * В режиме POOL_FLAG_THREAD_SAFE каждый поток работает со своим небольшим
+ * кэшем блоков, а общий список свободных блоков за кэшами является
+ * lock-free стеком, защищенным от ABA тегом версии. Блок можно освободить
+ * из любого потока, а не только из того, который его выделил.
+ * 
+ * С POOL_FLAG_HUGEPAGES арена отображается через mmap на явных 2 МБ
+ * страницах; если их нет, используется обычное отображение с MADV_HUGEPAGE.
+ * С POOL_FLAG_PREFAULT все страницы арены затрагиваются при создании,
+ * чтобы первые page faults не попадали в pool_alloc; крупная арена
+ * прогревается параллельно (prefault_range) до mlock, иначе mlock сам
+ * загрузил бы страницы в одном потоке. Неудачный mlock
+ * всегда сообщается в stderr, а с POOL_FLAG_MLOCK_REQUIRED приводит к
+ * ошибке создания (errno сохраняется).
+ * 
+ * С POOL_FLAG_NUMA_BIND арена отображается через mmap и до прогрева и
+ * mlock привязывается к узлу options->numa_node через mbind(MPOL_BIND);
+ * потоки прогрева работают на ядрах этого узла. Ошибка привязки (в том
+ * числе несуществующий узел) приводит к ошибке создания.
+ * 
+ * Если задан options->arena, блоки размещаются в переданной памяти:
+ * пул не освобождает ее при уничтожении, а POOL_FLAG_HUGEPAGES и
+ * POOL_FLAG_NUMA_BIND игнорируются.
+ * 
+ * options->alignment задает выравнивание начала арены и шаг блоков:
+ * размер блока округляется вверх до кратного выравниванию. По умолчанию
+ * блоки идут вплотную, а в режиме POOL_FLAG_THREAD_SAFE выравниваются по
+ * кэш-линии, чтобы блоки, отданные разным потокам, не делили одну линию.
+ * 
+ * Если options->max_block_count больше block_count, пул растущий: под
+ * max_block_count блоков сразу резервируется непрерывный диапазон адресов
+ * (без выделения памяти), а фоновый поток каждые POOL_GROW_POLL_US мкс
+ * проверяет запас и, когда свободных блоков меньше grow_watermark,
+ * фиксирует, прогревает и блокирует (mlock) следующую порцию из grow_chunk
+ * блоков. pool_alloc сам никогда не вызывает mmap и не вызывает page fault:
+ * новые блоки попадают в список готовыми. Несовместимо с options->arena.
+ * 
+ * Список свободных блоков размечается по возрастанию адресов, так что
+ * последовательные pool_alloc идут по памяти вперед, в направлении работы
+ * аппаратного prefetcher-а. С POOL_FLAG_INDEX_LIST (однопоточный режим)
+ * звенья списка хранят 32-битный номер следующего блока, а минимальный
+ * размер блока уменьшается до 4 байт.
+ * 
+ * @param block_size Размер одного блока в байтах.
+ * @param block_count Количество блоков в пуле.
+ * @param options Параметры пула (NULL — параметры по умолчанию).
+ * @return Указатель на созданный пул или NULL в случае ошибки.
+ */
+MemoryPool* pool_create_ex(size_t block_size, size_t block_count, const PoolOptions* options);
+
 /**
  * @brief Выделяет один блок из пула.
  * 
@@ -30,6 +170,72 @@ void* pool_alloc(MemoryPool* pool);
  */
 void pool_free(MemoryPool* pool, void* block);
 
+/**
+ * @brief Выделяет до count блоков за один вызов.
+ * 
+ * Блоки снимаются с головы списка одной операцией (в потокобезопасном
+ * режиме — сначала из кэша потока, затем цепочками из общего стека).
+ * 
+ * @param pool Указатель на пул.
+ * @param ptrs Массив для указателей на выделенные блоки.
+ * @param count Сколько блоков требуется.
+ * @return Число выделенных блоков (меньше count, если пул исчерпан).
+ */
+size_t pool_alloc_bulk(MemoryPool* pool, void** ptrs, size_t count);
+
+/**
+ * @brief Возвращает count блоков в пул за один вызов.
+ * 
+ * Блоки связываются в цепочку и присоединяются к списку свободных одной
+ * операцией. Элементы ptrs, равные NULL, пропускаются.
+ * 
+ * @param pool Указатель на пул.
+ * @param ptrs Массив указателей на освобождаемые блоки.
+ * @param count Число элементов в ptrs.
+ */
+void pool_free_bulk(MemoryPool* pool, void** ptrs, size_t count);
+
+/**
+ * @brief Возвращает блоки из кэша текущего потока в общий список.
+ * 
+ * Вызывается потоком перед завершением, чтобы его кэшированные блоки
+ * стали доступны остальным потокам. Для однопоточного пула ничего не делает.
+ * 
+ * @param pool Указатель на пул.
+ */
+void pool_thread_flush(MemoryPool* pool);
+
+/**
+ * @brief Возвращает статистику использования пула.
+ * 
+ * Счетчики ведутся всегда и стоят одного сложения на операцию: в
+ * потокобезопасном режиме у каждого потока свои счетчики, и чтение здесь
+ * суммирует их без остановки потоков. В этом режиме high_water считает
+ * блоки, снятые с общего стека (выделенные и лежащие в кэшах потоков), —
+ * это верхняя оценка нужного block_count. Гистограммы задержек
+ * заполняются только с POOL_FLAG_LATENCY_STATS.
+ * 
+ * @param pool Указатель на пул.
+ * @param stats Структура для заполнения.
+ */
+void pool_stats(const MemoryPool* pool, PoolStats* stats);
+
+/**
+ * @brief Возвращает фактический размер блока (шаг между блоками) с учетом выравнивания.
+ * 
+ * @param pool Указатель на пул.
+ * @return Размер блока в байтах.
+ */
+size_t pool_block_size(const MemoryPool* pool);
+
+/**
+ * @brief Возвращает сведения об арене пула.
+ * 
+ * @param pool Указатель на пул.
+ * @param info Структура для заполнения.
+ */
+void pool_arena_info(const MemoryPool* pool, PoolArenaInfo* info);
+
 /**
  * @brief Уничтожает пул и освобождает всю выделенную под него память.
  * 
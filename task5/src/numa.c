@@ -0,0 +1,136 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "numa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+// Маска узлов для mbind/set_mempolicy: ядро читает maxnode - 1 бит
+#define MASK_WORDS ((NUMA_MAX_NODES + 63) / 64)
+
+static int fake_nodes(void) {
+    const char* value = getenv(NUMA_FAKE_ENV);
+    if (!value) return 0;
+    int n = atoi(value);
+    if (n < 1) return 0;
+    return n > NUMA_MAX_NODES ? NUMA_MAX_NODES : n;
+}
+
+// Число реальных узлов по /sys/devices/system/node/possible ("0" или "0-3")
+static int real_node_count(void) {
+    FILE* f = fopen("/sys/devices/system/node/possible", "r");
+    if (!f) return 1;
+    int first = 0, last = 0;
+    int n = fscanf(f, "%d-%d", &first, &last);
+    fclose(f);
+    if (n < 1) return 1;
+    if (n == 1) last = first;
+    int count = last + 1;
+    if (count < 1) count = 1;
+    return count > NUMA_MAX_NODES ? NUMA_MAX_NODES : count;
+}
+
+int numa_node_count(void) {
+    int fake = fake_nodes();
+    return fake ? fake : real_node_count();
+}
+
+int numa_is_fake(void) {
+    return fake_nodes() != 0;
+}
+
+int numa_real_node(int node) {
+    return fake_nodes() ? node % real_node_count() : node;
+}
+
+// Разобрать список ядер в формате cpulist ("0-3,8-11"), оставив доступные процессу
+static int parse_cpulist(FILE* f, const cpu_set_t* allowed, int* cpus, int max) {
+    int count = 0;
+    int first, last;
+    char sep;
+    while (count < max && fscanf(f, "%d", &first) == 1) {
+        last = first;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &last) != 1) break;
+            if (fscanf(f, "%c", &sep) != 1) sep = '\n';
+        }
+        for (int cpu = first; cpu <= last && count < max; ++cpu) {
+            if (CPU_ISSET(cpu, allowed)) cpus[count++] = cpu;
+        }
+        if (sep != ',') break;
+    }
+    return count;
+}
+
+int numa_node_cpus(int node, int* cpus, int max) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+        CPU_SET(0, &allowed);
+    }
+
+    int count = 0;
+    int fake = fake_nodes();
+    if (fake) {
+        // Фиктивный узел k получает каждое fake-е доступное ядро, начиная с k-го
+        int index = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE && count < max; ++cpu) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            if (index++ % fake == node % fake) cpus[count++] = cpu;
+        }
+    } else {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* f = fopen(path, "r");
+        if (f) {
+            count = parse_cpulist(f, &allowed, cpus, max);
+            fclose(f);
+        }
+    }
+
+    if (count == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE && count < max; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) cpus[count++] = cpu;
+        }
+    }
+    return count;
+}
+
+int numa_bind_range(void* addr, size_t len, int node) {
+    if (node < 0 || node >= numa_node_count()) {
+        errno = EINVAL;
+        return -1;
+    }
+    unsigned long mask[MASK_WORDS] = { 0 };
+    int real = numa_real_node(node);
+    mask[real / 64] |= 1UL << (real % 64);
+    return (int)syscall(SYS_mbind, addr, len, MPOL_BIND, mask, (unsigned long)NUMA_MAX_NODES + 1, 0);
+}
+
+int numa_bind_thread(int node) {
+    if (node < 0) {
+        return (int)syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+    }
+    if (node >= numa_node_count()) {
+        errno = EINVAL;
+        return -1;
+    }
+    unsigned long mask[MASK_WORDS] = { 0 };
+    int real = numa_real_node(node);
+    mask[real / 64] |= 1UL << (real % 64);
+    return (int)syscall(SYS_set_mempolicy, MPOL_BIND, mask, (unsigned long)NUMA_MAX_NODES + 1);
+}
+
+int numa_page_node(void* addr) {
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
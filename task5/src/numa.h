@@ -0,0 +1,67 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stddef.h>
+
+// Переменная окружения, задающая фиктивную топологию из N узлов. Узел k
+// отображается на реальный узел k % (число реальных узлов), а доступные
+// ядра делятся между фиктивными узлами по кругу. Так код, зависящий от
+// нескольких узлов, можно проверить на машине с одним узлом
+#define NUMA_FAKE_ENV "NUMA_FAKE_NODES"
+
+#define NUMA_MAX_NODES 64
+
+/**
+ * @brief Возвращает число узлов NUMA (с учетом NUMA_FAKE_NODES).
+ *
+ * Если /sys/devices/system/node недоступен, считается, что узел один.
+ */
+int numa_node_count(void);
+
+/**
+ * @brief Возвращает 1, если действует фиктивная топология.
+ */
+int numa_is_fake(void);
+
+/**
+ * @brief Возвращает реальный узел, на котором размещается память узла node.
+ */
+int numa_real_node(int node);
+
+/**
+ * @brief Заполняет список доступных процессу ядер узла.
+ *
+ * @param node Узел (в текущей, возможно фиктивной, топологии).
+ * @param cpus Массив для номеров ядер.
+ * @param max Емкость массива.
+ * @return Число ядер; если у узла нет доступных ядер — все доступные ядра.
+ */
+int numa_node_cpus(int node, int* cpus, int max);
+
+/**
+ * @brief Привязывает диапазон к узлу через mbind(MPOL_BIND).
+ *
+ * Вызывается до первого обращения к страницам (и до mlock), иначе уже
+ * выделенные страницы остаются на прежнем узле.
+ *
+ * @param addr Начало диапазона (выровнено по странице).
+ * @param len Размер диапазона.
+ * @param node Узел.
+ * @return 0 при успехе, -1 при ошибке (errno от mbind или EINVAL для неверного узла).
+ */
+int numa_bind_range(void* addr, size_t len, int node);
+
+/**
+ * @brief Задает политику MPOL_BIND для будущих выделений вызывающего потока (set_mempolicy).
+ *
+ * @param node Узел, -1 — вернуть политику по умолчанию.
+ * @return 0 при успехе, -1 при ошибке.
+ */
+int numa_bind_thread(int node);
+
+/**
+ * @brief Возвращает реальный узел, на котором находится страница addr (-1, если неизвестно).
+ */
+int numa_page_node(void* addr);
+
+#endif // NUMA_H
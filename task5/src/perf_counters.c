@@ -0,0 +1,159 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "perf_counters.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+static const char* counter_names[PERF_CNT_COUNT] = {
+    "cycles", "minor-faults", "major-faults", "dTLB-misses"
+};
+
+const char* perf_counter_name(PerfCounterId id) {
+    return id < PERF_CNT_COUNT ? counter_names[id] : "?";
+}
+
+static void fill_attr(struct perf_event_attr* attr, PerfCounterId id, int user_only) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->read_format = PERF_FORMAT_GROUP;
+    attr->exclude_kernel = user_only;
+    attr->exclude_hv = 1;
+    switch (id) {
+        case PERF_CNT_CYCLES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_CNT_MINOR_FAULTS:
+            attr->type = PERF_TYPE_SOFTWARE;
+            attr->config = PERF_COUNT_SW_PAGE_FAULTS_MIN;
+            break;
+        case PERF_CNT_MAJOR_FAULTS:
+            attr->type = PERF_TYPE_SOFTWARE;
+            attr->config = PERF_COUNT_SW_PAGE_FAULTS_MAJ;
+            break;
+        default:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_DTLB |
+                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+    }
+}
+
+static int open_counter(PerfCounterId id, int user_only, int group_fd) {
+    struct perf_event_attr attr;
+    fill_attr(&attr, id, user_only);
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void group_reset(PerfGroup* group) {
+    group->leader_fd = -1;
+    group->size = 0;
+}
+
+unsigned perf_counters_open(PerfCounters* pc, unsigned mask) {
+    memset(pc, 0, sizeof(*pc));
+    group_reset(&pc->hardware);
+    group_reset(&pc->software);
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        pc->counters[i].fd = -1;
+    }
+
+    // Программное событие есть и без PMU, поэтому по нему проверяется,
+    // разрешены ли события ядра (perf_event_paranoid < 2)
+    int probe = open_counter(PERF_CNT_MINOR_FAULTS, 0, -1);
+    if (probe >= 0) {
+        close(probe);
+    } else {
+        pc->user_only = 1;
+    }
+
+    // Аппаратные и программные счетчики — в разных группах: программный
+    // счетчик в группе запретил бы чтение группы через rdpmc
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        if (!(mask & PERF_MASK(i))) continue;
+        PerfGroup* group = (PERF_MASK_HARDWARE & PERF_MASK(i)) ? &pc->hardware : &pc->software;
+        int fd = open_counter((PerfCounterId)i, pc->user_only, group->leader_fd);
+        if (fd < 0) continue;
+
+        if (group->leader_fd < 0) group->leader_fd = fd;
+        pc->counters[i].fd = fd;
+        pc->mask |= PERF_MASK(i);
+        group->order[group->size++] = i;
+    }
+    if (!pc->mask) return 0;
+
+    // rdpmc доступен, только если ядро разрешило его для каждого
+    // аппаратного счетчика (cap_user_rdpmc и ненулевой index)
+    pc->use_rdpmc = pc->hardware.size > 0;
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        if (!(pc->mask & PERF_MASK_HARDWARE & PERF_MASK(i))) continue;
+        void* page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, pc->counters[i].fd, 0);
+        if (page == MAP_FAILED) {
+            pc->use_rdpmc = 0;
+            continue;
+        }
+        pc->counters[i].page = (struct perf_event_mmap_page*)page;
+    }
+#if !defined(__x86_64__) && !defined(__i386__)
+    pc->use_rdpmc = 0;
+#endif
+
+    PerfGroup* groups[] = { &pc->hardware, &pc->software };
+    for (int g = 0; g < 2; ++g) {
+        if (groups[g]->leader_fd < 0) continue;
+        ioctl(groups[g]->leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(groups[g]->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // index в mmap-странице заполняется, когда счетчик включен и размещен на PMU
+    for (int i = 0; i < PERF_CNT_COUNT && pc->use_rdpmc; ++i) {
+        const PerfCounter* counter = &pc->counters[i];
+        if (!counter->page) continue;
+        if (!counter->page->cap_user_rdpmc || counter->page->index == 0) pc->use_rdpmc = 0;
+    }
+    return pc->mask;
+}
+
+static void group_read(const PerfGroup* group, uint64_t* values) {
+    uint64_t buffer[1 + PERF_CNT_COUNT];
+    if (group->leader_fd < 0) return;
+    ssize_t n = read(group->leader_fd, buffer, sizeof(buffer));
+    if (n < (ssize_t)sizeof(uint64_t)) return;
+    uint64_t nr = buffer[0];
+    for (uint64_t i = 0; i < nr && i < (uint64_t)group->size; ++i) {
+        values[group->order[i]] = buffer[1 + i];
+    }
+}
+
+void perf_counters_read_syscall(const PerfCounters* pc, uint64_t* values) {
+    group_read(&pc->hardware, values);
+}
+
+void perf_counters_read_software(const PerfCounters* pc, uint64_t* values) {
+    group_read(&pc->software, values);
+}
+
+const char* perf_counters_hw_path(const PerfCounters* pc) {
+    if (pc->hardware.size == 0) return "none";
+    return pc->use_rdpmc ? "rdpmc" : "read()";
+}
+
+void perf_counters_close(PerfCounters* pc) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        if (pc->counters[i].page) munmap(pc->counters[i].page, page_size);
+        if (pc->counters[i].fd >= 0) close(pc->counters[i].fd);
+        pc->counters[i].page = NULL;
+        pc->counters[i].fd = -1;
+    }
+    pc->mask = 0;
+    group_reset(&pc->hardware);
+    group_reset(&pc->software);
+    pc->use_rdpmc = 0;
+}
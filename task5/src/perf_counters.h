@@ -0,0 +1,160 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <linux/perf_event.h>
+
+// Счетчики, которые умеет открывать слой
+typedef enum {
+    PERF_CNT_CYCLES,
+    PERF_CNT_MINOR_FAULTS,
+    PERF_CNT_MAJOR_FAULTS,
+    PERF_CNT_DTLB_MISSES,
+    PERF_CNT_COUNT
+} PerfCounterId;
+
+#define PERF_MASK(id) (1u << (id))
+#define PERF_MASK_ALL ((1u << PERF_CNT_COUNT) - 1)
+// Аппаратные счетчики читаются через rdpmc, программные (page faults) — только read()
+#define PERF_MASK_HARDWARE (PERF_MASK(PERF_CNT_CYCLES) | PERF_MASK(PERF_CNT_DTLB_MISSES))
+#define PERF_MASK_SOFTWARE (PERF_MASK(PERF_CNT_MINOR_FAULTS) | PERF_MASK(PERF_CNT_MAJOR_FAULTS))
+
+typedef struct {
+    int fd;                            // -1, если счетчик не открыт
+    struct perf_event_mmap_page* page; // Страница для чтения через rdpmc (NULL — нет)
+} PerfCounter;
+
+// Группа perf_event: читается одним read()
+typedef struct {
+    int leader_fd;             // -1 — в группе ничего не открыто
+    int order[PERF_CNT_COUNT]; // Порядок счетчиков в ответе read() группы
+    int size;
+} PerfGroup;
+
+/**
+ * @brief Набор счетчиков perf_event_open текущего потока.
+ *
+ * Счетчики разбиты на две группы. Аппаратные (такты, промахи dTLB)
+ * читаются инструкцией rdpmc без системных вызовов, если ядро это
+ * разрешило, иначе одним read() группы. Программные счетчики page faults
+ * не размещаются на PMU (index в mmap-странице всегда 0), поэтому rdpmc
+ * к ним неприменим: их группа читается только read() через
+ * perf_counters_read_software там, где системный вызов допустим.
+ */
+typedef struct {
+    PerfCounter counters[PERF_CNT_COUNT];
+    unsigned mask;             // Какие счетчики открыты
+    PerfGroup hardware;
+    PerfGroup software;
+    int use_rdpmc;             // 1 — все открытые аппаратные счетчики доступны через rdpmc
+    int user_only;             // 1 — пришлось исключить события ядра (perf_event_paranoid)
+} PerfCounters;
+
+/**
+ * @brief Открывает запрошенные счетчики для текущего потока.
+ *
+ * Недоступные счетчики (нет PMU в виртуальной машине, запрет
+ * perf_event_paranoid) пропускаются. Сначала счетчики открываются с
+ * учетом событий ядра — обработка page fault выполняется в ядре; если
+ * это запрещено, открываются только пользовательские.
+ *
+ * @param pc Набор счетчиков.
+ * @param mask Комбинация PERF_MASK(id).
+ * @return Маска реально открытых счетчиков (0 — ни одного).
+ */
+unsigned perf_counters_open(PerfCounters* pc, unsigned mask);
+
+/**
+ * @brief Закрывает все счетчики набора.
+ *
+ * @param pc Набор счетчиков.
+ */
+void perf_counters_close(PerfCounters* pc);
+
+/**
+ * @brief Возвращает имя счетчика для вывода.
+ */
+const char* perf_counter_name(PerfCounterId id);
+
+/**
+ * @brief Читает аппаратную группу через read() (когда rdpmc недоступен).
+ *
+ * @param pc Набор счетчиков.
+ * @param values Массив из PERF_CNT_COUNT значений; неоткрытые не изменяются.
+ */
+void perf_counters_read_syscall(const PerfCounters* pc, uint64_t* values);
+
+/**
+ * @brief Читает программные счетчики (page faults) одним read().
+ *
+ * Это системный вызов: в горячем цикле его стоит делать реже, чем
+ * perf_counters_read, или только вне замеряемого участка.
+ *
+ * @param pc Набор счетчиков.
+ * @param values Массив из PERF_CNT_COUNT значений; неоткрытые не изменяются.
+ */
+void perf_counters_read_software(const PerfCounters* pc, uint64_t* values);
+
+/**
+ * @brief Описание способа чтения аппаратных счетчиков для вывода:
+ * "rdpmc", "read()" или "none".
+ */
+const char* perf_counters_hw_path(const PerfCounters* pc);
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t perf_rdpmc(unsigned index) {
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(index));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Чтение одного счетчика через rdpmc по протоколу perf_event_mmap_page:
+// значение = offset + аппаратный счетчик, согласованность по seqlock.
+// Возвращает -1, если счетчик сейчас не размещен на PMU
+static inline int perf_counter_rdpmc(const PerfCounter* counter, uint64_t* value) {
+    volatile struct perf_event_mmap_page* page = counter->page;
+    uint32_t seq;
+    uint64_t count;
+    do {
+        seq = page->lock;
+        __asm__ __volatile__("" ::: "memory");
+        uint32_t index = page->index;
+        if (!page->cap_user_rdpmc || index == 0) return -1;
+        int64_t pmc = (int64_t)perf_rdpmc(index - 1);
+        unsigned width = page->pmc_width;
+        pmc = (int64_t)((uint64_t)pmc << (64 - width)) >> (64 - width);
+        count = (uint64_t)(page->offset + pmc);
+        __asm__ __volatile__("" ::: "memory");
+    } while (page->lock != seq);
+    *value = count;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Читает текущие значения открытых аппаратных счетчиков.
+ *
+ * Предназначена для горячего пути: при доступном rdpmc не делает
+ * системных вызовов. Программные счетчики не читаются (см.
+ * perf_counters_read_software); они и неоткрытые в values не изменяются.
+ *
+ * @param pc Набор счетчиков.
+ * @param values Массив из PERF_CNT_COUNT значений.
+ */
+static inline void perf_counters_read(const PerfCounters* pc, uint64_t* values) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (pc->use_rdpmc) {
+        for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+            if (!(pc->mask & PERF_MASK_HARDWARE & PERF_MASK(i))) continue;
+            if (perf_counter_rdpmc(&pc->counters[i], &values[i]) != 0) {
+                perf_counters_read_syscall(pc, values);
+                return;
+            }
+        }
+        return;
+    }
+#endif
+    perf_counters_read_syscall(pc, values);
+}
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,115 @@
+#include "prefault.h"
+#include "numa.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define CHUNK_ALIGN (2UL * 1024 * 1024)
+
+typedef struct {
+    char* start;
+    size_t size;
+    int cpu; // -1 — не закреплять
+} Worker;
+
+static void touch_range(char* start, size_t size) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    volatile char* p = (volatile char*)start;
+    for (size_t offset = 0; offset < size; offset += page_size) {
+        p[offset] = 0;
+    }
+}
+
+static void* worker_func(void* arg) {
+    Worker* worker = (Worker*)arg;
+    if (worker->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    touch_range(worker->start, worker->size);
+    return NULL;
+}
+
+int prefault_current_node(void) {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return 0;
+    return (int)node;
+}
+
+int prefault_range(void* start, size_t size, const PrefaultOptions* options, PrefaultResult* result) {
+    if (!start || size == 0) return -1;
+    int requested = options ? options->threads : 0;
+    int node = options && options->numa_node >= 0 ? options->numa_node : prefault_current_node();
+    unsigned flags = options ? options->flags : 0;
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    char* base = (char*)start;
+    if (flags & PREFAULT_HUGEPAGES) {
+        // madvise требует выровненного начала: подсказка применяется
+        // к целым 2 МБ страницам внутри диапазона
+        uintptr_t lo = ((uintptr_t)base + CHUNK_ALIGN - 1) & ~(uintptr_t)(CHUNK_ALIGN - 1);
+        uintptr_t hi = ((uintptr_t)base + size) & ~(uintptr_t)(CHUNK_ALIGN - 1);
+        if (hi > lo) madvise((void*)lo, hi - lo, MADV_HUGEPAGE);
+    }
+
+    int cpus[PREFAULT_MAX_THREADS];
+    int cpu_count = numa_node_cpus(node, cpus, PREFAULT_MAX_THREADS);
+    int threads = requested > 0 ? requested : cpu_count;
+    if (requested <= 0 && (size_t)threads > size / PREFAULT_MIN_CHUNK) {
+        threads = (int)(size / PREFAULT_MIN_CHUNK);
+    }
+    if (threads > PREFAULT_MAX_THREADS) threads = PREFAULT_MAX_THREADS;
+    if (threads < 1) threads = 1;
+
+    // Границы участков выровнены по 2 МБ относительно адреса
+    size_t chunk = (size + (size_t)threads - 1) / (size_t)threads;
+    chunk = (chunk + CHUNK_ALIGN - 1) & ~(CHUNK_ALIGN - 1);
+    uintptr_t aligned_base = (uintptr_t)base & ~(uintptr_t)(CHUNK_ALIGN - 1);
+
+    Worker workers[PREFAULT_MAX_THREADS];
+    pthread_t handles[PREFAULT_MAX_THREADS];
+    int started[PREFAULT_MAX_THREADS] = { 0 };
+    int used = 0;
+    for (int i = 0; i < threads; ++i) {
+        char* lo = (char*)(aligned_base + (size_t)i * chunk);
+        char* hi = (char*)(aligned_base + (size_t)(i + 1) * chunk);
+        if (lo < base) lo = base;
+        if (hi > base + size) hi = base + size;
+        if (lo >= hi) break;
+        workers[used] = (Worker){ lo, (size_t)(hi - lo), cpus[used % cpu_count] };
+        ++used;
+    }
+
+    if (used == 1) {
+        touch_range(workers[0].start, workers[0].size);
+    } else {
+        for (int i = 0; i < used; ++i) {
+            started[i] = pthread_create(&handles[i], NULL, worker_func, &workers[i]) == 0;
+        }
+        for (int i = 0; i < used; ++i) {
+            if (started[i]) {
+                pthread_join(handles[i], NULL);
+            } else {
+                touch_range(workers[i].start, workers[i].size);
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (result) {
+        result->bytes = size;
+        result->threads = used;
+        result->numa_node = node;
+        result->elapsed_ns = (end.tv_sec - begin.tv_sec) * 1000000000LL + (end.tv_nsec - begin.tv_nsec);
+        result->gb_per_sec = result->elapsed_ns > 0 ? (double)size / (double)result->elapsed_ns : 0.0;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef PREFAULT_H
+#define PREFAULT_H
+
+#include <stddef.h>
+
+// Флаги прогрева (поле PrefaultOptions.flags)
+#define PREFAULT_HUGEPAGES (1u << 0) // Перед прогревом запросить THP для диапазона (MADV_HUGEPAGE)
+
+#define PREFAULT_MAX_THREADS 64
+#define PREFAULT_MIN_CHUNK (32UL * 1024 * 1024) // Меньшие участки прогреваются одним потоком
+
+/**
+ * @brief Параметры прогрева.
+ */
+typedef struct {
+    int threads;    // Число потоков (0 — по числу ядер узла, но не больше size / PREFAULT_MIN_CHUNK)
+    int numa_node;  // Узел, на ядрах которого работают потоки (-1 — узел вызывающего потока)
+    unsigned flags; // Комбинация флагов PREFAULT_*
+} PrefaultOptions;
+
+/**
+ * @brief Результат прогрева.
+ */
+typedef struct {
+    size_t bytes;
+    int threads;
+    int numa_node;
+    long long elapsed_ns;
+    double gb_per_sec;
+} PrefaultResult;
+
+/**
+ * @brief Затрагивает каждую страницу диапазона записью, разделив работу между потоками.
+ *
+ * Диапазон делится на участки, выровненные по 2 МБ, чтобы каждую
+ * большую страницу заполнял один поток. Потоки закрепляются за ядрами
+ * узла numa_node: при политике first touch страницы выделяются на узле
+ * того ядра, которое первым к ним обратилось. Если участок один, он
+ * прогревается в вызывающем потоке без создания новых.
+ *
+ * @param start Начало диапазона.
+ * @param size Размер диапазона в байтах.
+ * @param options Параметры (NULL — значения по умолчанию).
+ * @param result Куда записать результат (может быть NULL).
+ * @return 0 при успехе, -1 при неверных аргументах.
+ */
+int prefault_range(void* start, size_t size, const PrefaultOptions* options, PrefaultResult* result);
+
+/**
+ * @brief Возвращает узел NUMA, на котором выполняется вызывающий поток (0, если неизвестно).
+ */
+int prefault_current_node(void);
+
+#endif // PREFAULT_H
@@ -0,0 +1,180 @@
+#include "ring.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define CACHE_LINE 64
+
+// Сколько элементов ring_consume извлекает за один проход
+#define CONSUME_BATCH 32
+
+// Элемент буфера. seq используется только в режиме RING_MPSC: слот
+// свободен для позиции pos, когда seq == pos, и заполнен, когда seq == pos + 1
+typedef struct {
+    _Atomic size_t seq;
+    MemoryPool* pool;
+    void* block;
+} Slot;
+
+struct BlockRing {
+    RingMode mode;
+    size_t mask;
+    Slot* slots;
+
+    // Сторона производителя
+    _Alignas(CACHE_LINE) _Atomic size_t tail;
+    size_t cached_head; // Последнее прочитанное значение head (только SPSC)
+
+    // Сторона потребителя
+    _Alignas(CACHE_LINE) _Atomic size_t head;
+    size_t cached_tail; // Последнее прочитанное значение tail (только SPSC)
+};
+
+BlockRing* ring_create(size_t capacity, RingMode mode) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    BlockRing* ring = (BlockRing*)aligned_alloc(_Alignof(BlockRing), sizeof(BlockRing));
+    if (!ring) return NULL;
+    ring->slots = (Slot*)aligned_alloc(CACHE_LINE, (size * sizeof(Slot) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1));
+    if (!ring->slots) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->mode = mode;
+    ring->mask = size - 1;
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+    for (size_t i = 0; i < size; ++i) {
+        atomic_init(&ring->slots[i].seq, i);
+        ring->slots[i].pool = NULL;
+        ring->slots[i].block = NULL;
+    }
+    return ring;
+}
+
+// SPSC: производитель сверяется с кэшированным head и перечитывает
+// его из общей кэш-линии, только когда места по кэшу не хватает
+static size_t spsc_enqueue(BlockRing* ring, MemoryPool* pool, void** blocks, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t capacity = ring->mask + 1;
+    if (capacity - (tail - ring->cached_head) < count) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    }
+    size_t free_slots = capacity - (tail - ring->cached_head);
+    if (count > free_slots) count = free_slots;
+
+    for (size_t i = 0; i < count; ++i) {
+        Slot* slot = &ring->slots[(tail + i) & ring->mask];
+        slot->pool = pool;
+        slot->block = blocks[i];
+    }
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+static size_t spsc_dequeue(BlockRing* ring, void** blocks, MemoryPool** pools, size_t count) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (ring->cached_tail - head < count) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    }
+    size_t available = ring->cached_tail - head;
+    if (count > available) count = available;
+
+    for (size_t i = 0; i < count; ++i) {
+        Slot* slot = &ring->slots[(head + i) & ring->mask];
+        blocks[i] = slot->block;
+        if (pools) pools[i] = slot->pool;
+    }
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+// MPSC: производители резервируют диапазон позиций CAS-ом по tail.
+// Потребитель освобождает слоты строго по порядку, поэтому если свободен
+// последний слот диапазона, свободны и все предыдущие
+static size_t mpsc_enqueue(BlockRing* ring, MemoryPool* pool, void** blocks, size_t count) {
+    if (count == 0 || count > ring->mask + 1) return 0;
+    size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;) {
+        Slot* last = &ring->slots[(pos + count - 1) & ring->mask];
+        size_t seq = atomic_load_explicit(&last->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + count - 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + count,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0; // Буфер полон
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Slot* slot = &ring->slots[(pos + i) & ring->mask];
+        slot->pool = pool;
+        slot->block = blocks[i];
+        atomic_store_explicit(&slot->seq, pos + i + 1, memory_order_release);
+    }
+    return count;
+}
+
+static size_t mpsc_dequeue(BlockRing* ring, void** blocks, MemoryPool** pools, size_t count) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t n = 0;
+    while (n < count) {
+        Slot* slot = &ring->slots[(head + n) & ring->mask];
+        // Слот мог быть зарезервирован, но еще не заполнен производителем
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + n + 1) break;
+        blocks[n] = slot->block;
+        if (pools) pools[n] = slot->pool;
+        atomic_store_explicit(&slot->seq, head + n + ring->mask + 1, memory_order_release);
+        ++n;
+    }
+    atomic_store_explicit(&ring->head, head + n, memory_order_relaxed);
+    return n;
+}
+
+int ring_enqueue(BlockRing* ring, MemoryPool* pool, void* block) {
+    return ring_enqueue_bulk(ring, pool, &block, 1) == 1 ? 0 : -1;
+}
+
+size_t ring_enqueue_bulk(BlockRing* ring, MemoryPool* pool, void** blocks, size_t count) {
+    if (!ring || !blocks) return 0;
+    if (ring->mode == RING_SPSC) return spsc_enqueue(ring, pool, blocks, count);
+    return mpsc_enqueue(ring, pool, blocks, count);
+}
+
+size_t ring_dequeue_bulk(BlockRing* ring, void** blocks, MemoryPool** pools, size_t count) {
+    if (!ring || !blocks) return 0;
+    if (ring->mode == RING_SPSC) return spsc_dequeue(ring, blocks, pools, count);
+    return mpsc_dequeue(ring, blocks, pools, count);
+}
+
+size_t ring_consume(BlockRing* ring, RingHandler handler, void* ctx, size_t max) {
+    void* blocks[CONSUME_BATCH];
+    MemoryPool* pools[CONSUME_BATCH];
+    size_t total = 0;
+    while (total < max) {
+        size_t want = max - total < CONSUME_BATCH ? max - total : CONSUME_BATCH;
+        size_t n = ring_dequeue_bulk(ring, blocks, pools, want);
+        if (n == 0) break;
+        for (size_t i = 0; i < n; ++i) {
+            if (handler) handler(blocks[i], ctx);
+            pool_free(pools[i], blocks[i]);
+        }
+        total += n;
+    }
+    return total;
+}
+
+void ring_destroy(BlockRing* ring) {
+    if (!ring) return;
+    free(ring->slots);
+    free(ring);
+}
@@ -0,0 +1,86 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include "mempool.h"
+
+typedef struct BlockRing BlockRing;
+
+// Режим кольцевого буфера
+typedef enum {
+    RING_SPSC, // Один производитель, один потребитель
+    RING_MPSC  // Несколько производителей, один потребитель
+} RingMode;
+
+/**
+ * @brief Обработчик блока, вызываемый потребителем в ring_consume.
+ */
+typedef void (*RingHandler)(void* block, void* ctx);
+
+/**
+ * @brief Создает lock-free кольцевой буфер фиксированной емкости для передачи блоков пула.
+ *
+ * Каждый элемент — пара (пул, блок), поэтому потребитель может вернуть
+ * блок в тот пул, из которого он был выделен. Индексы производителя и
+ * потребителя лежат на разных кэш-линиях. Если блоки освобождаются
+ * потребителем, а выделяются производителем, пул должен быть создан с
+ * POOL_FLAG_THREAD_SAFE.
+ *
+ * @param capacity Емкость в элементах (округляется вверх до степени двойки).
+ * @param mode RING_SPSC или RING_MPSC.
+ * @return Указатель на буфер или NULL в случае ошибки.
+ */
+BlockRing* ring_create(size_t capacity, RingMode mode);
+
+/**
+ * @brief Помещает один блок в буфер (вызывается производителем).
+ *
+ * @param ring Указатель на буфер.
+ * @param pool Пул, из которого выделен блок.
+ * @param block Указатель на блок.
+ * @return 0 при успехе, -1 если буфер полон.
+ */
+int ring_enqueue(BlockRing* ring, MemoryPool* pool, void* block);
+
+/**
+ * @brief Помещает до count блоков одного пула за одну публикацию.
+ *
+ * @param ring Указатель на буфер.
+ * @param pool Пул, из которого выделены блоки.
+ * @param blocks Массив блоков.
+ * @param count Число блоков.
+ * @return Сколько блоков помещено (0, если места не хватило: в режиме
+ *         RING_MPSC пакет помещается целиком или не помещается вовсе).
+ */
+size_t ring_enqueue_bulk(BlockRing* ring, MemoryPool* pool, void** blocks, size_t count);
+
+/**
+ * @brief Извлекает до count элементов (вызывается потребителем).
+ *
+ * @param ring Указатель на буфер.
+ * @param blocks Массив для блоков.
+ * @param pools Массив для пулов блоков (может быть NULL).
+ * @param count Максимальное число элементов.
+ * @return Сколько элементов извлечено.
+ */
+size_t ring_dequeue_bulk(BlockRing* ring, void** blocks, MemoryPool** pools, size_t count);
+
+/**
+ * @brief Извлекает до max элементов, передает каждый блок обработчику и возвращает его в пул.
+ *
+ * @param ring Указатель на буфер.
+ * @param handler Обработчик блока (может быть NULL).
+ * @param ctx Контекст обработчика.
+ * @param max Максимальное число элементов за вызов.
+ * @return Сколько блоков обработано.
+ */
+size_t ring_consume(BlockRing* ring, RingHandler handler, void* ctx, size_t max);
+
+/**
+ * @brief Уничтожает буфер. Оставшиеся в нем блоки в пулы не возвращаются.
+ *
+ * @param ring Указатель на буфер.
+ */
+void ring_destroy(BlockRing* ring);
+
+#endif // RING_H
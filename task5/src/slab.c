@@ -0,0 +1,109 @@
+#include "slab.h"
+#include "mempool.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+// Число классов до 64 байт включительно (16, 32, 48, 64)
+#define SMALL_CLASSES 4
+
+struct SlabAllocator {
+    char* region;       // Непрерывный диапазон под все классы
+    size_t region_size;
+    int span_shift;     // log2 размера участка одного класса
+    MemoryPool* pools[SLAB_NUM_CLASSES];
+};
+
+// Индекс класса для запроса size за O(1): для size > 64 берется старший
+// бит (size - 1) и два следующих за ним бита задают четверть октавы
+static int size_to_class(size_t size) {
+    if (size <= 64) {
+        return size == 0 ? 0 : (int)((size + 15) / 16) - 1;
+    }
+    int k = 63 - __builtin_clzll((unsigned long long)(size - 1));
+    int sub = (int)((size - 1) >> (k - 2)) & 3;
+    return SMALL_CLASSES + (k - 6) * 4 + sub;
+}
+
+static size_t class_to_size(int index) {
+    if (index < SMALL_CLASSES) {
+        return (size_t)(index + 1) * 16;
+    }
+    int k = (index - SMALL_CLASSES) / 4 + 6;
+    int sub = (index - SMALL_CLASSES) % 4;
+    return (size_t)(sub + 5) << (k - 2);
+}
+
+size_t slab_class_size(size_t size) {
+    if (size > SLAB_MAX_SIZE) return 0;
+    return class_to_size(size_to_class(size));
+}
+
+SlabAllocator* slab_create(size_t class_capacity, unsigned pool_flags) {
+    // Участок класса — степень двойки, вмещающая хотя бы один самый крупный
+    // блок вместе с канарейкой проверяемой сборки
+    size_t max_stride = (SLAB_MAX_SIZE + POOL_GUARD_SIZE + 15) & ~(size_t)15;
+    int span_shift = 0;
+    while (((size_t)1 << span_shift) < class_capacity || ((size_t)1 << span_shift) < max_stride) {
+        ++span_shift;
+    }
+    size_t span = (size_t)1 << span_shift;
+
+    SlabAllocator* slab = (SlabAllocator*)calloc(1, sizeof(SlabAllocator));
+    if (!slab) return NULL;
+
+    slab->span_shift = span_shift;
+    slab->region_size = span * SLAB_NUM_CLASSES;
+    slab->region = mmap(NULL, slab->region_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slab->region == MAP_FAILED) {
+        free(slab);
+        return NULL;
+    }
+    // Внешнюю арену пулы не отображают сами, поэтому hugepages
+    // запрашиваются для всего диапазона целиком
+    if (pool_flags & POOL_FLAG_HUGEPAGES) {
+        madvise(slab->region, slab->region_size, MADV_HUGEPAGE);
+    }
+
+    for (int i = 0; i < SLAB_NUM_CLASSES; ++i) {
+        size_t block_size = class_to_size(i);
+        PoolOptions options = {
+            .flags = pool_flags & ~POOL_FLAG_HUGEPAGES,
+            .arena = slab->region + (size_t)i * span,
+            .arena_size = span,
+            .alignment = 16, // Классы кратны 16, блоки идут вплотную
+        };
+        // В проверяемой сборке к каждому блоку добавляется канарейка
+        size_t stride = (block_size + POOL_GUARD_SIZE + 15) & ~(size_t)15;
+        slab->pools[i] = pool_create_ex(block_size, span / stride, &options);
+        if (!slab->pools[i]) {
+            slab_destroy(slab);
+            return NULL;
+        }
+    }
+
+    return slab;
+}
+
+void* slab_alloc(SlabAllocator* slab, size_t size) {
+    if (!slab || size > SLAB_MAX_SIZE) return NULL;
+    return pool_alloc(slab->pools[size_to_class(size)]);
+}
+
+void slab_free(SlabAllocator* slab, void* ptr) {
+    if (!slab || !ptr) return;
+    // Пул-владелец определяется смещением указателя в общем диапазоне
+    size_t offset = (size_t)((char*)ptr - slab->region);
+    if ((char*)ptr < slab->region || offset >= slab->region_size) return;
+    pool_free(slab->pools[offset >> slab->span_shift], ptr);
+}
+
+void slab_destroy(SlabAllocator* slab) {
+    if (!slab) return;
+    for (int i = 0; i < SLAB_NUM_CLASSES; ++i) {
+        pool_destroy(slab->pools[i]);
+    }
+    munmap(slab->region, slab->region_size);
+    free(slab);
+}
@@ -0,0 +1,62 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+
+typedef struct SlabAllocator SlabAllocator;
+
+// Диапазон размеров, обслуживаемых слабами
+#define SLAB_MIN_SIZE 16
+#define SLAB_MAX_SIZE 65536
+
+// Классы размеров: кратные 16 до 64 байт, далее по четыре класса на каждую
+// степень двойки (x1.25, x1.5, x1.75, x2), т.е. шаг между классами не более 1.25x
+#define SLAB_NUM_CLASSES 44
+
+/**
+ * @brief Создает слаб-аллокатор поверх набора пулов памяти.
+ *
+ * Под каждый класс размеров создается отдельный MemoryPool. Все пулы
+ * лежат в одном непрерывном диапазоне адресов на участках одинакового
+ * размера (степень двойки), поэтому пул-владелец блока определяется по
+ * адресу за O(1), без заголовка у блока.
+ *
+ * @param class_capacity Объем памяти на один класс в байтах (округляется вверх до степени двойки).
+ * @param pool_flags Флаги POOL_FLAG_*, передаваемые пулам классов.
+ * @return Указатель на аллокатор или NULL в случае ошибки.
+ */
+SlabAllocator* slab_create(size_t class_capacity, unsigned pool_flags);
+
+/**
+ * @brief Выделяет блок не меньше size байт из подходящего класса.
+ *
+ * @param slab Указатель на аллокатор.
+ * @param size Запрошенный размер в байтах.
+ * @return Указатель на блок или NULL, если size > SLAB_MAX_SIZE либо класс исчерпан.
+ */
+void* slab_alloc(SlabAllocator* slab, size_t size);
+
+/**
+ * @brief Возвращает блок в пул его класса.
+ *
+ * @param slab Указатель на аллокатор.
+ * @param ptr Указатель, полученный от slab_alloc.
+ */
+void slab_free(SlabAllocator* slab, void* ptr);
+
+/**
+ * @brief Возвращает размер класса, которым будет обслужен запрос size.
+ *
+ * @param size Запрошенный размер в байтах.
+ * @return Размер блока класса или 0, если size > SLAB_MAX_SIZE.
+ */
+size_t slab_class_size(size_t size);
+
+/**
+ * @brief Уничтожает аллокатор и все его пулы.
+ *
+ * @param slab Указатель на аллокатор.
+ */
+void slab_destroy(SlabAllocator* slab);
+
+#endif // SLAB_H
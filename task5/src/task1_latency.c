@@ -1,35 +1,77 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <stdint.h>
 #include <sys/resource.h>
+#include "perf_counters.h"
 
 #define ARRAY_SIZE (512 * 1024 * 1024) // 512 MB
 #define PAGE_SIZE 4096
 #define NUM_ITERATIONS 1000
+#define FAULT_SAMPLE_EVERY 100 // Итераций между чтениями счетчиков отказов
+#define NUM_FAULT_BATCHES ((NUM_ITERATIONS + FAULT_SAMPLE_EVERY - 1) / FAULT_SAMPLE_EVERY)
 
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
+// Результаты одной итерации. Буфер выделяется до цикла и выводится
+// после него, чтобы printf не попадал между замерами
+typedef struct {
+    long long latency;
+    uint64_t counts[PERF_CNT_COUNT];
+} IterSample;
+
+// Отказы страниц за партию из FAULT_SAMPLE_EVERY итераций: программные
+// счетчики читаются только read(), поэтому не на каждой итерации
+typedef struct {
+    int first;
+    uint64_t counts[PERF_CNT_COUNT];
+} FaultBatch;
+
 int main() {
     printf("Task 1: Demonstrating Page Faults\n");
 
     // Выделить большой массив с помощью malloc
     char *array = (char *)malloc(ARRAY_SIZE);
-    if (!array) {
+    IterSample *samples = (IterSample *)calloc(NUM_ITERATIONS, sizeof(IterSample));
+    FaultBatch *batches = (FaultBatch *)calloc(NUM_FAULT_BATCHES, sizeof(FaultBatch));
+    if (!array || !samples || !batches) {
         perror("malloc failed");
         return 1;
     }
+    // Затронуть буфер результатов заранее, чтобы его страницы не давали отказов в цикле
+    memset(samples, 0, NUM_ITERATIONS * sizeof(IterSample));
+    memset(batches, 0, NUM_FAULT_BATCHES * sizeof(FaultBatch));
+
+    // Счетчики perf_event_open вместо getrusage. Циклы и промахи dTLB
+    // читаются на каждой итерации (rdpmc, если ядро его разрешило),
+    // отказы страниц — read() раз в FAULT_SAMPLE_EVERY итераций
+    PerfCounters pc;
+    unsigned opened = perf_counters_open(&pc, PERF_MASK_ALL);
+    printf("Counters: %s (hardware: %s%s; faults: %s every %d iterations)\n",
+           opened ? "perf_event_open" : "unavailable",
+           perf_counters_hw_path(&pc), pc.user_only ? ", user space only" : "",
+           (opened & PERF_MASK_SOFTWARE) ? "read()" : "none", FAULT_SAMPLE_EVERY);
 
     struct timespec start_time, end_time;
     struct rusage usage_before, usage_after;
+    uint64_t before[PERF_CNT_COUNT] = { 0 }, after[PERF_CNT_COUNT] = { 0 };
+    uint64_t faults_before[PERF_CNT_COUNT] = { 0 }, faults_after[PERF_CNT_COUNT] = { 0 };
 
-    printf("Iter\tLatency (ns)\tMinor Faults\tMajor Faults\n");
+    getrusage(RUSAGE_SELF, &usage_before);
 
     for (int i = 0; i < NUM_ITERATIONS; ++i) {
-        // Получить статистику использования ресурсов ДО доступа к памяти (getrusage)
-        getrusage(RUSAGE_SELF, &usage_before);
+        // Отказы страниц — вне замера, на границе партии
+        if (i % FAULT_SAMPLE_EVERY == 0) {
+            perf_counters_read_software(&pc, faults_before);
+            batches[i / FAULT_SAMPLE_EVERY].first = i;
+        }
+
+        // Прочитать счетчики ДО доступа к памяти
+        perf_counters_read(&pc, before);
 
         // Замерить время ДО доступа
         clock_gettime(CLOCK_MONOTONIC, &start_time);
@@ -42,16 +84,71 @@ int main() {
         // Замерить время ПОСЛЕ доступа
         clock_gettime(CLOCK_MONOTONIC, &end_time);
 
-        // Получить статистику использования ресурсов ПОСЛЕ доступа
-        getrusage(RUSAGE_SELF, &usage_after);
+        // Прочитать счетчики ПОСЛЕ доступа
+        perf_counters_read(&pc, after);
+
+        samples[i].latency = timespec_diff_ns(start_time, end_time);
+        for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+            samples[i].counts[c] = after[c] - before[c];
+        }
+
+        if ((i + 1) % FAULT_SAMPLE_EVERY == 0 || i + 1 == NUM_ITERATIONS) {
+            perf_counters_read_software(&pc, faults_after);
+            FaultBatch *batch = &batches[i / FAULT_SAMPLE_EVERY];
+            for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+                batch->counts[c] = faults_after[c] - faults_before[c];
+            }
+        }
+    }
 
-        long long latency = timespec_diff_ns(start_time, end_time);
-        long minor_faults = usage_after.ru_minflt - usage_before.ru_minflt;
-        long major_faults = usage_after.ru_majflt - usage_before.ru_majflt;
+    getrusage(RUSAGE_SELF, &usage_after);
+    perf_counters_close(&pc);
 
-        printf("%d\t%lld\t\t%ld\t\t%ld\n", i, latency, minor_faults, major_faults);
+    printf("Iter\tLatency (ns)");
+    for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+        if (PERF_MASK_HARDWARE & PERF_MASK(c)) printf("\t%s", perf_counter_name((PerfCounterId)c));
     }
+    printf("\n");
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        printf("%d\t%lld\t\t", i, samples[i].latency);
+        for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+            if (!(PERF_MASK_HARDWARE & PERF_MASK(c))) continue;
+            if (opened & PERF_MASK(c)) {
+                printf("%llu\t", (unsigned long long)samples[i].counts[c]);
+            } else {
+                printf("n/a\t");
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\nIters");
+    for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+        if (PERF_MASK_SOFTWARE & PERF_MASK(c)) printf("\t\t%s", perf_counter_name((PerfCounterId)c));
+    }
+    printf("\n");
+    for (int b = 0; b < NUM_FAULT_BATCHES; ++b) {
+        int last = batches[b].first + FAULT_SAMPLE_EVERY - 1;
+        if (last >= NUM_ITERATIONS) last = NUM_ITERATIONS - 1;
+        printf("%d-%d", batches[b].first, last);
+        for (int c = 0; c < PERF_CNT_COUNT; ++c) {
+            if (!(PERF_MASK_SOFTWARE & PERF_MASK(c))) continue;
+            if (opened & PERF_MASK(c)) {
+                printf("\t\t%llu", (unsigned long long)batches[b].counts[c]);
+            } else {
+                printf("\t\tn/a");
+            }
+        }
+        printf("\n");
+    }
+
+    // Сверка с getrusage за весь цикл
+    printf("Total faults (getrusage): minor %ld, major %ld\n",
+           usage_after.ru_minflt - usage_before.ru_minflt,
+           usage_after.ru_majflt - usage_before.ru_majflt);
 
+    free(batches);
+    free(samples);
     free(array);
     return 0;
 }
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <linux/mman.h>
+#include "latency_hist.h"
+#include "bench_timer.h"
+
+#define DEFAULT_SIZE_MB 512
+#define PAGE_SIZE 4096
+#define HUGEPAGE_SIZE (2 * 1024 * 1024)
+#define STRIDE_PAGES 17 // Шаг обхода: взаимно прост с числом страниц в 2 МБ
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23 // Linux 5.14+
+#endif
+
+long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+// Размер страниц буфера
+typedef enum {
+    PAGES_4K,
+    PAGES_THP,
+    PAGES_HUGETLB,
+    NUM_PAGE_KINDS
+} PageKind;
+
+// Способ подготовить память до первого обращения
+typedef enum {
+    PREFAULT_NONE,     // Страницы выделяются по требованию при обращении
+    PREFAULT_POPULATE, // MAP_POPULATE (для THP — MADV_POPULATE_WRITE после MADV_HUGEPAGE)
+    PREFAULT_ONFAULT,  // mlock2(MLOCK_ONFAULT): страницы закрепляются при первом обращении
+    PREFAULT_WILLNEED, // madvise(MADV_WILLNEED)
+    PREFAULT_PRETOUCH, // Запись в каждую страницу вручную
+    NUM_PREFAULTS
+} Prefault;
+
+// Порядок обращений к страницам
+typedef enum {
+    PATTERN_SEQUENTIAL,
+    PATTERN_STRIDED,
+    PATTERN_RANDOM,
+    NUM_PATTERNS
+} Pattern;
+
+static const char* page_kind_names[NUM_PAGE_KINDS] = { "4KB", "THP", "hugetlb" };
+static const char* prefault_names[NUM_PREFAULTS] = { "none", "populate", "onfault", "willneed", "pretouch" };
+static const char* pattern_names[NUM_PATTERNS] = { "seq", "strided", "random" };
+
+// Порядок обхода 4 КБ страниц для каждого шаблона
+static void fill_order(uint32_t* order, size_t pages, Pattern pattern) {
+    size_t n = 0;
+    switch (pattern) {
+        case PATTERN_SEQUENTIAL:
+            for (size_t i = 0; i < pages; ++i) order[i] = (uint32_t)i;
+            break;
+        case PATTERN_STRIDED:
+            for (size_t start = 0; start < STRIDE_PAGES; ++start) {
+                for (size_t i = start; i < pages; i += STRIDE_PAGES) order[n++] = (uint32_t)i;
+            }
+            break;
+        default: {
+            for (size_t i = 0; i < pages; ++i) order[i] = (uint32_t)i;
+            // Фишер-Йетс на xorshift
+            uint32_t seed = 2463534242u;
+            for (size_t i = pages - 1; i > 0; --i) {
+                seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+                size_t j = seed % (uint32_t)(i + 1);
+                uint32_t tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+            }
+            break;
+        }
+    }
+}
+
+// Отобразить буфер нужного вида, применяя способ подготовки.
+// Возвращает NULL, если такие страницы недоступны
+static char* map_buffer(PageKind kind, Prefault prefault, size_t size) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (prefault == PREFAULT_POPULATE && kind != PAGES_THP) flags |= MAP_POPULATE;
+
+    char* buf;
+    if (kind == PAGES_HUGETLB) {
+        buf = mmap(NULL, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        if (buf == MAP_FAILED) return NULL;
+    } else if (kind == PAGES_THP) {
+        // Выровнять начало по 2 МБ, чтобы весь буфер собирался из THP
+        char* raw = mmap(NULL, size + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (raw == MAP_FAILED) return NULL;
+        buf = (char*)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+        if (buf > raw) munmap(raw, (size_t)(buf - raw));
+        size_t tail = (size_t)((raw + size + HUGEPAGE_SIZE) - (buf + size));
+        if (tail > 0) munmap(buf + size, tail);
+        if (madvise(buf, size, MADV_HUGEPAGE) != 0) {
+            munmap(buf, size);
+            return NULL;
+        }
+    } else {
+        buf = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (buf == MAP_FAILED) return NULL;
+        // Исключить THP, если он включен в режиме always
+        madvise(buf, size, MADV_NOHUGEPAGE);
+    }
+
+    size_t step = kind == PAGES_4K ? PAGE_SIZE : HUGEPAGE_SIZE;
+    switch (prefault) {
+        case PREFAULT_POPULATE:
+            // MAP_POPULATE срабатывает до MADV_HUGEPAGE, поэтому для THP заполняем отдельно
+            if (kind == PAGES_THP && madvise(buf, size, MADV_POPULATE_WRITE) != 0) {
+                for (size_t i = 0; i < size; i += step) buf[i] = 0;
+            }
+            break;
+        case PREFAULT_ONFAULT:
+            if (mlock2(buf, size, MLOCK_ONFAULT) != 0) perror("mlock2 failed");
+            break;
+        case PREFAULT_WILLNEED:
+            madvise(buf, size, MADV_WILLNEED);
+            break;
+        case PREFAULT_PRETOUCH:
+            for (size_t i = 0; i < size; i += step) buf[i] = 0;
+            break;
+        default:
+            break;
+    }
+    return buf;
+}
+
+// Один случай: подготовка буфера (время и отказы страниц), затем
+// по одному замеренному обращению к каждой 4 КБ странице
+static int profile_case(PageKind kind, Prefault prefault, Pattern pattern,
+                        size_t size, const uint32_t* order, LatencyHist* hist) {
+    struct timespec start, end;
+    struct rusage before, middle, after;
+
+    getrusage(RUSAGE_SELF, &before);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    char* buf = map_buffer(kind, prefault, size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    getrusage(RUSAGE_SELF, &middle);
+    if (!buf) return -1;
+
+    size_t pages = size / PAGE_SIZE;
+    hist_init(hist);
+    for (size_t i = 0; i < pages; ++i) {
+        volatile char* p = buf + (size_t)order[i] * PAGE_SIZE;
+        uint64_t t0 = timer_start();
+        *p = 1;
+        uint64_t t1 = timer_stop();
+        hist_record(hist, timer_elapsed_ns(t0, t1));
+    }
+    getrusage(RUSAGE_SELF, &after);
+
+    printf("%-8s %-9s %-8s %10.2f %9ld %9llu %9llu %9llu %10llu %9ld %6ld\n",
+           page_kind_names[kind], prefault_names[prefault], pattern_names[pattern],
+           timespec_diff_ns(start, end) / 1e6,
+           middle.ru_minflt - before.ru_minflt,
+           (unsigned long long)hist_percentile(hist, 50.0),
+           (unsigned long long)hist_percentile(hist, 99.0),
+           (unsigned long long)hist_percentile(hist, 99.9),
+           (unsigned long long)hist->max,
+           after.ru_minflt - middle.ru_minflt,
+           after.ru_majflt - before.ru_majflt);
+
+    munmap(buf, size);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = DEFAULT_SIZE_MB;
+    TimerSource source = TIMER_CLOCK;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--tsc") == 0) {
+            source = TIMER_TSC;
+        } else {
+            size_mb = (size_t)atol(argv[i]);
+        }
+    }
+    if (size_mb < 2) size_mb = 2;
+    size_mb &= ~(size_t)1; // Кратно 2 МБ для hugetlb
+    size_t size = size_mb * 1024 * 1024;
+    size_t pages = size / PAGE_SIZE;
+
+    if (timer_init(source) != 0) {
+        printf("Invariant TSC not available, falling back to clock_gettime\n");
+    }
+
+    printf("Page fault profile: %zu MB buffer, one write per 4KB page (%zu accesses)\n", size_mb, pages);
+    printf("Timer: %s, overhead %.1f ns subtracted\n", timer_source_name(), timer_overhead_ns());
+    printf("Setup = mmap + prefault step; access latencies in ns; faults counted by getrusage\n\n");
+    printf("%-8s %-9s %-8s %10s %9s %9s %9s %9s %10s %9s %6s\n",
+           "Pages", "Prefault", "Pattern", "Setup(ms)", "SetupMin", "p50", "p99", "p99.9", "Max",
+           "AccessMin", "Major");
+
+    uint32_t* orders[NUM_PATTERNS];
+    for (int p = 0; p < NUM_PATTERNS; ++p) {
+        orders[p] = (uint32_t*)malloc(pages * sizeof(uint32_t));
+        if (!orders[p]) {
+            perror("malloc failed");
+            return 1;
+        }
+        fill_order(orders[p], pages, (Pattern)p);
+    }
+
+    LatencyHist* hist = (LatencyHist*)malloc(sizeof(LatencyHist));
+    if (!hist) {
+        perror("malloc failed");
+        return 1;
+    }
+
+    for (int k = 0; k < NUM_PAGE_KINDS; ++k) {
+        for (int f = 0; f < NUM_PREFAULTS; ++f) {
+            for (int p = 0; p < NUM_PATTERNS; ++p) {
+                if (profile_case((PageKind)k, (Prefault)f, (Pattern)p, size, orders[p], hist) != 0) {
+                    printf("%-8s unavailable%s\n", page_kind_names[k],
+                           k == PAGES_HUGETLB ? " (reserve pages with: sysctl vm.nr_hugepages=N)" : "");
+                    f = NUM_PREFAULTS; // Остальные случаи этого вида тоже недоступны
+                    break;
+                }
+            }
+        }
+    }
+
+    free(hist);
+    for (int p = 0; p < NUM_PATTERNS; ++p) free(orders[p]);
+    return 0;
+}
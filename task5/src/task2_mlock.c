@@ -4,6 +4,7 @@
 #include <time.h>
 #include <sys/resource.h>
 #include <sys/mman.h>
+#include "prefault.h"
 
 #define ARRAY_SIZE (512 * 1024 * 1024) // 512 MB
 #define PAGE_SIZE 4096
@@ -16,24 +17,29 @@ long long timespec_diff_ns(struct timespec start, struct timespec end) {
 int main() {
     printf("Task 2: Preventing Page Faults with mlockall\n");
 
-    // Заблокировать текущую и будущую память процесса в RAM
-    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
-        perror("mlockall failed. Try running with sudo.");
-        return 1;
-    }
-
     char *array = (char *)malloc(ARRAY_SIZE);
     if (!array) {
         perror("malloc failed");
         return 1;
     }
 
-    // "Прогреть" память, чтобы вызвать все minor faults на этапе инициализации
+    // "Прогреть" память, чтобы вызвать все minor faults на этапе инициализации.
+    // Диапазон делится между потоками, закрепленными за ядрами текущего узла NUMA
     printf("Pre-faulting memory...\n");
-    for (size_t i = 0; i < ARRAY_SIZE; i += PAGE_SIZE) {
-        array[i] = 0;
+    PrefaultOptions prefault = { .threads = 0, .numa_node = -1, .flags = PREFAULT_HUGEPAGES };
+    PrefaultResult result;
+    prefault_range(array, ARRAY_SIZE, &prefault, &result);
+    printf("Memory pre-faulting complete: %d threads on node %d, %.1f ms, %.2f GB/s\n",
+           result.threads, result.numa_node, result.elapsed_ns / 1e6, result.gb_per_sec);
+
+    // Заблокировать текущую и будущую память процесса в RAM. mlockall идет
+    // после прогрева: иначе он сам загрузил бы весь буфер в одном потоке,
+    // и прогреву было бы нечего делать
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed. Try running with sudo.");
+        free(array);
+        return 1;
     }
-    printf("Memory pre-faulting complete.\n");
 
     struct timespec start_time, end_time;
     struct rusage usage_before, usage_after;
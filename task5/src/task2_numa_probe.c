@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "numa.h"
+#include "mempool.h"
+
+#define DEFAULT_SIZE_MB 256
+#define LINE_SIZE 64
+#define MAX_CHASE_STEPS (4 * 1024 * 1024)
+#define BANDWIDTH_PASSES 3
+#define POOL_PROBE_BLOCKS 4096
+
+long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+// Закрепиться за первым ядром узла. Сначала возвращается исходная маска:
+// numa_node_cpus пересекает ядра узла с текущей маской, и после прошлого
+// закрепления на одно ядро другие узлы оказались бы без ядер
+static int pin_to_node(int node, const cpu_set_t* original) {
+    if (sched_setaffinity(0, sizeof(*original), original) != 0) return -1;
+    int cpus[CPU_SETSIZE];
+    if (numa_node_cpus(node, cpus, CPU_SETSIZE) == 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[0], &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) return -1;
+    return cpus[0];
+}
+
+// Замкнуть все кэш-линии буфера в один случайный цикл (алгоритм Саттоло):
+// каждое обращение зависит от предыдущего и промахивается мимо кэша
+static void build_chain(char* buf, size_t lines, uint32_t* perm) {
+    for (size_t i = 0; i < lines; ++i) perm[i] = (uint32_t)i;
+    uint32_t seed = 2463534242u;
+    for (size_t i = lines - 1; i > 0; --i) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        size_t j = seed % (uint32_t)i;
+        uint32_t tmp = perm[i]; perm[i] = perm[j]; perm[j] = tmp;
+    }
+    for (size_t i = 0; i < lines; ++i) {
+        *(char**)(buf + (size_t)i * LINE_SIZE) = buf + (size_t)perm[i] * LINE_SIZE;
+    }
+}
+
+// Средняя задержка зависимого чтения, нс
+static double chase_latency(char* buf, size_t lines) {
+    size_t steps = lines < MAX_CHASE_STEPS ? lines : MAX_CHASE_STEPS;
+    struct timespec start, end;
+    char* p = buf;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < steps; ++i) {
+        p = *(char**)p;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    // Не дать компилятору выбросить цикл
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+    return (double)timespec_diff_ns(start, end) / (double)steps;
+}
+
+// Пропускная способность последовательного чтения, ГБ/с (лучший из проходов)
+static double read_bandwidth(const char* buf, size_t size) {
+    double best = 0.0;
+    for (int pass = 0; pass < BANDWIDTH_PASSES; ++pass) {
+        const uint64_t* words = (const uint64_t*)buf;
+        uint64_t sum = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < size / sizeof(uint64_t); ++i) {
+            sum += words[i];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        __asm__ __volatile__("" : : "r"(sum) : "memory");
+        double gbs = (double)size / (double)timespec_diff_ns(start, end);
+        if (gbs > best) best = gbs;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = DEFAULT_SIZE_MB;
+    if (argc > 1) size_mb = (size_t)atol(argv[1]);
+    if (size_mb < 1) size_mb = 1;
+    size_t size = size_mb * 1024 * 1024;
+    size_t lines = size / LINE_SIZE;
+
+    int nodes = numa_node_count();
+    printf("NUMA probe: %d node(s)%s, %zu MB buffer per node pair\n",
+           nodes, numa_is_fake() ? " (fake topology from " NUMA_FAKE_ENV ")" : "", size_mb);
+    if (nodes == 1) {
+        printf("Single NUMA node: only local figures are available "
+               "(set " NUMA_FAKE_ENV "=N to exercise the node-pair matrix)\n");
+    }
+
+    uint32_t* perm = (uint32_t*)malloc(lines * sizeof(uint32_t));
+    double* latency = (double*)calloc((size_t)nodes * nodes, sizeof(double));
+    double* bandwidth = (double*)calloc((size_t)nodes * nodes, sizeof(double));
+    if (!perm || !latency || !bandwidth) {
+        perror("malloc failed");
+        return 1;
+    }
+
+    cpu_set_t original;
+    if (sched_getaffinity(0, sizeof(original), &original) != 0) {
+        perror("sched_getaffinity failed");
+        return 1;
+    }
+
+    printf("\nCPU node\tMem node\tCPU\tPage node\tLatency (ns)\tBandwidth (GB/s)\n");
+    for (int cpu_node = 0; cpu_node < nodes; ++cpu_node) {
+        int cpu = pin_to_node(cpu_node, &original);
+        for (int mem_node = 0; mem_node < nodes; ++mem_node) {
+            char* buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (buf == MAP_FAILED) {
+                perror("mmap failed");
+                return 1;
+            }
+            if (numa_bind_range(buf, size, mem_node) != 0) {
+                perror("mbind failed");
+                munmap(buf, size);
+                continue;
+            }
+            build_chain(buf, lines, perm);
+
+            double* lat = &latency[cpu_node * nodes + mem_node];
+            double* bw = &bandwidth[cpu_node * nodes + mem_node];
+            *lat = chase_latency(buf, lines);
+            *bw = read_bandwidth(buf, size);
+            printf("%8d\t%8d\t%3d\t%9d\t%12.1f\t%16.2f\n",
+                   cpu_node, mem_node, cpu, numa_page_node(buf), *lat, *bw);
+            munmap(buf, size);
+        }
+    }
+
+    sched_setaffinity(0, sizeof(original), &original);
+
+    // Сводка: отношение удаленного доступа к локальному
+    if (nodes > 1) {
+        printf("\nRemote/local latency ratio:\n");
+        for (int i = 0; i < nodes; ++i) {
+            for (int j = 0; j < nodes; ++j) {
+                double local = latency[i * nodes + i];
+                printf("%6.2f ", local > 0 ? latency[i * nodes + j] / local : 0.0);
+            }
+            printf("\n");
+        }
+    }
+
+    // Привязка арены пула: узел первой страницы после создания
+    printf("\nMemoryPool with POOL_FLAG_NUMA_BIND:\n");
+    for (int node = 0; node < nodes; ++node) {
+        PoolOptions options = { .flags = POOL_FLAG_NUMA_BIND | POOL_FLAG_PREFAULT, .numa_node = node };
+        MemoryPool* pool = pool_create_ex(LINE_SIZE, POOL_PROBE_BLOCKS, &options);
+        if (!pool) {
+            printf("node %d: pool_create failed\n", node);
+            continue;
+        }
+        void* block = pool_alloc(pool);
+        printf("node %d: arena on real node %d (expected %d)\n",
+               node, numa_page_node(block), numa_real_node(node));
+        pool_free(pool, block);
+        pool_destroy(pool);
+    }
+
+    free(bandwidth);
+    free(latency);
+    free(perm);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "prefault.h"
+#include "mempool.h"
+
+#define DEFAULT_SIZE_MB 1024
+#define BLOCK_SIZE 4096
+
+long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+// Время отображения и прогрева нового диапазона заданным числом потоков
+static void bench_range(const char* label, size_t size, int threads, unsigned flags) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    char* buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+        perror("mmap failed");
+        return;
+    }
+    PrefaultOptions options = { .threads = threads, .numa_node = -1, .flags = flags };
+    PrefaultResult result;
+    prefault_range(buf, size, &options, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%-8s\t%7d\t%12.1f\t%8.2f\n", label, result.threads,
+           timespec_diff_ns(start, end) / 1e6, result.gb_per_sec);
+    munmap(buf, size);
+}
+
+// Время pool_create с POOL_FLAG_PREFAULT: прогрев + mlock + разметка блоков
+static void bench_pool(size_t size, int threads) {
+    struct timespec start, end;
+    PoolOptions options = {
+        .flags = POOL_FLAG_PREFAULT | POOL_FLAG_HUGEPAGES,
+        .prefault_threads = threads,
+    };
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, size / BLOCK_SIZE, &options);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+    double elapsed_ms = timespec_diff_ns(start, end) / 1e6;
+    printf("%-8s\t%7d\t%12.1f\t%8.2f\n", "pool", threads, elapsed_ms, size / (elapsed_ms * 1e6));
+    pool_destroy(pool);
+}
+
+int main(int argc, char* argv[]) {
+    size_t size_mb = DEFAULT_SIZE_MB;
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc > 1) size_mb = (size_t)atol(argv[1]);
+    if (argc > 2) max_threads = atoi(argv[2]);
+    if (size_mb < 2) size_mb = 2;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > PREFAULT_MAX_THREADS) max_threads = PREFAULT_MAX_THREADS;
+    size_t size = size_mb * 1024 * 1024;
+
+    printf("Startup time vs prefault threads: %zu MB, threads on NUMA node %d\n",
+           size_mb, prefault_current_node());
+    printf("Memory\t\tThreads\tStartup (ms)\tGB/s\n");
+
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        bench_range("4KB", size, threads, 0);
+        bench_range("THP", size, threads, PREFAULT_HUGEPAGES);
+        bench_pool(size, threads);
+        if (threads == max_threads) break;
+    }
+    return 0;
+}
@@ -1,78 +1,624 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/utsname.h>
 #include "mempool.h"
+#include "slab.h"
+#include "latency_hist.h"
+#include "bench_timer.h"
+#include "perf_counters.h"
 
 #define BENCH_ITERATIONS 1000000
 #define BLOCK_SIZE 128
 
+// Смешанная нагрузка: окно живых объектов разного размера
+#define MIXED_LIVE_OBJECTS 1024
+#define SLAB_CLASS_CAPACITY (2 * 1024 * 1024)
+
+// Запись в соседние блоки из двух потоков
+#define SHARING_WRITES 50000000L
+#define SHARING_BLOCK_SIZE 16
+
+// Пакетное выделение: размер пакета как в пути обработки пакетов
+#define BULK_MAX_BURST 64
+#define BULK_POOL_BLOCKS 4096
+
+// Растущий пул: всплески выделений уводят пул за начальный размер
+#define GROW_INITIAL_BLOCKS 4096
+#define GROW_MAX_BLOCKS (256 * 1024)
+#define GROW_TARGET_BLOCKS (64 * 1024)
+#define GROW_BURST 256
+#define GROW_PAUSE_NS 50000
+
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
+// Формат вывода результатов
+typedef enum {
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_JSON // Один JSON-объект на строку
+} OutputFormat;
+
+static OutputFormat output_format = OUTPUT_TEXT;
+static struct utsname host_info;
+
+// Пояснительный вывод. В машиночитаемых форматах он уходит в stderr,
+// чтобы stdout содержал только записи результатов
+static void info(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(output_format == OUTPUT_TEXT ? stdout : stderr, fmt, args);
+    va_end(args);
+}
+
+static void print_csv_header(void) {
+    printf("host,kernel,timer,overhead_ns,benchmark,variant,operation,samples,"
+           "min_ns,mean_ns,p50_ns,p99_ns,p99_9_ns,p99_99_ns,max_ns\n");
+}
+
+// Запись распределения задержек: режим бенчмарка, вариант (аллокатор,
+// тип страниц и т.п.) и измеряемая операция
+static void report_latency(const char* bench, const char* variant, const char* op,
+                           const LatencyHist* hist) {
+    unsigned long long min = hist->count ? hist->min : 0;
+    unsigned long long p50 = hist_percentile(hist, 50.0);
+    unsigned long long p99 = hist_percentile(hist, 99.0);
+    unsigned long long p999 = hist_percentile(hist, 99.9);
+    unsigned long long p9999 = hist_percentile(hist, 99.99);
+    unsigned long long max = hist->max;
+    unsigned long long samples = hist->count;
+
+    switch (output_format) {
+        case OUTPUT_CSV:
+            printf("%s,%s,%s,%.1f,%s,%s,%s,%llu,%llu,%.1f,%llu,%llu,%llu,%llu,%llu\n",
+                   host_info.nodename, host_info.release, timer_source_name(), timer_overhead_ns(),
+                   bench, variant, op, samples, min, hist_mean(hist), p50, p99, p999, p9999, max);
+            break;
+        case OUTPUT_JSON:
+            printf("{\"host\":\"%s\",\"kernel\":\"%s\",\"timer\":\"%s\",\"overhead_ns\":%.1f,"
+                   "\"benchmark\":\"%s\",\"variant\":\"%s\",\"operation\":\"%s\",\"samples\":%llu,"
+                   "\"min_ns\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+                   "\"p99_9_ns\":%llu,\"p99_99_ns\":%llu,\"max_ns\":%llu}\n",
+                   host_info.nodename, host_info.release, timer_source_name(), timer_overhead_ns(),
+                   bench, variant, op, samples, min, hist_mean(hist), p50, p99, p999, p9999, max);
+            break;
+        default:
+            printf("%-12s %-10s avg: %7.1f  p50: %6llu  p99: %6llu  p99.9: %7llu  p99.99: %8llu  max: %9llu ns\n",
+                   variant, op, hist_mean(hist), p50, p99, p999, p9999, max);
+            break;
+    }
+}
+
 void benchmark_malloc() {
-    printf("Benchmarking malloc/free\n");
-    struct timespec start, end;
-    long long max_latency = 0;
-    void* ptrs[BENCH_ITERATIONS];
+    info("Benchmarking malloc/free\n");
+    static LatencyHist alloc_hist, free_hist;
+    hist_init(&alloc_hist);
+    hist_init(&free_hist);
+    // Массив указателей в куче: на стеке 8 МБ занимали весь стандартный лимит
+    void** ptrs = (void**)calloc(BENCH_ITERATIONS, sizeof(void*));
+    if (!ptrs) {
+        perror("calloc failed");
+        return;
+    }
 
     for (int i = 0; i < BENCH_ITERATIONS; ++i) {
-        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint64_t start = timer_start();
         ptrs[i] = malloc(BLOCK_SIZE);
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        long long latency = timespec_diff_ns(start, end);
-        if (latency > max_latency) max_latency = latency;
+        uint64_t stop = timer_stop();
+        hist_record(&alloc_hist, timer_elapsed_ns(start, stop));
     }
 
     for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        uint64_t start = timer_start();
         free(ptrs[i]);
+        uint64_t stop = timer_stop();
+        hist_record(&free_hist, timer_elapsed_ns(start, stop));
     }
 
-    printf("malloc/free max latency: %lld ns\n", max_latency);
+    report_latency("malloc", "malloc", "alloc", &alloc_hist);
+    report_latency("malloc", "malloc", "free", &free_hist);
+    free(ptrs);
 }
 
 void benchmark_mempool() {
-    printf("Benchmarking memory pool...\n");
-    struct timespec start, end;
-    long long max_latency = 0;
-    void* ptrs[BENCH_ITERATIONS];
+    info("Benchmarking memory pool...\n");
+    static LatencyHist alloc_hist, free_hist;
+    hist_init(&alloc_hist);
+    hist_init(&free_hist);
+    void** ptrs = (void**)calloc(BENCH_ITERATIONS, sizeof(void*));
+    if (!ptrs) {
+        perror("calloc failed");
+        return;
+    }
 
     // Создать пул с достаточным количеством блоков
     MemoryPool* pool = pool_create(BLOCK_SIZE, BENCH_ITERATIONS);
     if (!pool) {
         printf("Failed to create memory pool\n");
+        free(ptrs);
         return;
     }
 
     // Провести бенчмарк для pool_alloc
     for (int i = 0; i < BENCH_ITERATIONS; ++i) {
-        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint64_t start = timer_start();
         ptrs[i] = pool_alloc(pool);
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        long long latency = timespec_diff_ns(start, end);
-        if (latency > max_latency) max_latency = latency;
+        uint64_t stop = timer_stop();
+        hist_record(&alloc_hist, timer_elapsed_ns(start, stop));
     }
 
     // Освободить блоки
     for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        uint64_t start = timer_start();
         pool_free(pool, ptrs[i]);
+        uint64_t stop = timer_stop();
+        hist_record(&free_hist, timer_elapsed_ns(start, stop));
     }
 
-    printf("pool_alloc max latency: %lld ns\n", max_latency);
+    report_latency("pool", "pool", "alloc", &alloc_hist);
+    report_latency("pool", "pool", "free", &free_hist);
 
     // Уничтожить пул
     pool_destroy(pool);
+    free(ptrs);
+}
+
+static const char* page_kind_name(PoolPageKind kind) {
+    switch (kind) {
+        case POOL_PAGES_HUGETLB: return "2MB hugetlb";
+        case POOL_PAGES_THP:     return "THP";
+        default:                 return "4KB";
+    }
 }
 
-int main() {
+// Случайный обход всех блоков пула: на 4 КБ страницах почти каждый
+// доступ промахивается мимо dTLB, на 2 МБ — покрытие TLB в 512 раз больше
+static void benchmark_arena(const char* label, unsigned flags) {
+    void** ptrs = (void**)malloc(BENCH_ITERATIONS * sizeof(void*));
+    uint32_t* order = (uint32_t*)malloc(BENCH_ITERATIONS * sizeof(uint32_t));
+    PoolOptions options = { .flags = flags | POOL_FLAG_PREFAULT };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, BENCH_ITERATIONS, &options);
+    if (!ptrs || !order || !pool) {
+        printf("Failed to create %s arena\n", label);
+        free(ptrs);
+        free(order);
+        pool_destroy(pool);
+        return;
+    }
+
+    PoolArenaInfo arena;
+    pool_arena_info(pool, &arena);
+
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        ptrs[i] = pool_alloc(pool);
+        order[i] = (uint32_t)i;
+    }
+    // Перемешать порядок обхода (Фишер-Йетс на xorshift)
+    uint32_t seed = 2463534242u;
+    for (int i = BENCH_ITERATIONS - 1; i > 0; --i) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        uint32_t j = seed % (uint32_t)(i + 1);
+        uint32_t tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    }
+
+    // Проход без замеров отдельных доступов: среднее время, промахи dTLB и такты
+    struct timespec start, end;
+    PerfCounters pc;
+    unsigned opened = perf_counters_open(&pc, PERF_MASK(PERF_CNT_DTLB_MISSES) | PERF_MASK(PERF_CNT_CYCLES));
+    uint64_t before[PERF_CNT_COUNT] = { 0 }, after[PERF_CNT_COUNT] = { 0 };
+    perf_counters_read(&pc, before);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        ((volatile long*)ptrs[order[i]])[1]++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    perf_counters_read(&pc, after);
+    perf_counters_close(&pc);
+    double avg_ns = (double)timespec_diff_ns(start, end) / BENCH_ITERATIONS;
+
+    // Проход с замером каждого доступа: распределение задержек
+    static LatencyHist hist;
+    hist_init(&hist);
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        uint64_t t0 = timer_start();
+        ((volatile long*)ptrs[order[i]])[1]++;
+        uint64_t t1 = timer_stop();
+        hist_record(&hist, timer_elapsed_ns(t0, t1));
+    }
+
+    info("%-10s pages: %-11s locked: %-3s avg: %6.1f ns",
+         label, page_kind_name(arena.page_kind), arena.locked ? "yes" : "no", avg_ns);
+    static const PerfCounterId shown[] = { PERF_CNT_DTLB_MISSES, PERF_CNT_CYCLES };
+    for (size_t k = 0; k < sizeof(shown) / sizeof(shown[0]); ++k) {
+        PerfCounterId c = shown[k];
+        if (opened & PERF_MASK(c)) {
+            info("  %s: %llu", perf_counter_name(c), (unsigned long long)(after[c] - before[c]));
+        } else {
+            info("  %s: n/a", perf_counter_name(c));
+        }
+    }
+    info("\n");
+    report_latency("hugepages", label, "access", &hist);
+
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        pool_free(pool, ptrs[i]);
+    }
+    pool_destroy(pool);
+    free(order);
+    free(ptrs);
+}
+
+void benchmark_hugepages() {
+    info("Benchmarking 4KB vs hugepage arenas (random access to %d blocks)...\n", BENCH_ITERATIONS);
+    benchmark_arena("4KB", 0);
+    benchmark_arena("hugepage", POOL_FLAG_HUGEPAGES);
+}
+
+// Размеры запросов смешанной нагрузки: 70% до 256 Б, 25% до 4 КБ, 5% до 64 КБ
+static void fill_mixed_sizes(size_t* sizes, int count) {
+    uint32_t seed = 88172645u;
+    for (int i = 0; i < count; ++i) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        uint32_t bucket = seed % 100;
+        uint32_t r = seed >> 8;
+        if (bucket < 70) {
+            sizes[i] = 16 + r % (256 - 16);
+        } else if (bucket < 95) {
+            sizes[i] = 256 + r % (4096 - 256);
+        } else {
+            sizes[i] = 4096 + r % (SLAB_MAX_SIZE - 4096);
+        }
+    }
+}
+
+typedef struct {
+    LatencyHist alloc;
+    LatencyHist free;
+    long failed;
+} MixedResult;
+
+// Каждая итерация освобождает самый старый объект окна и выделяет новый
+static void run_mixed(const size_t* sizes, SlabAllocator* slab, MixedResult* res) {
+    void* live[MIXED_LIVE_OBJECTS] = { NULL };
+    hist_init(&res->alloc);
+    hist_init(&res->free);
+    res->failed = 0;
+
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        void** slot = &live[i % MIXED_LIVE_OBJECTS];
+        if (*slot) {
+            uint64_t start = timer_start();
+            if (slab) slab_free(slab, *slot); else free(*slot);
+            uint64_t stop = timer_stop();
+            hist_record(&res->free, timer_elapsed_ns(start, stop));
+        }
+
+        uint64_t start = timer_start();
+        *slot = slab ? slab_alloc(slab, sizes[i]) : malloc(sizes[i]);
+        uint64_t stop = timer_stop();
+        hist_record(&res->alloc, timer_elapsed_ns(start, stop));
+
+        if (*slot) {
+            *(volatile char*)*slot = 1;
+        } else {
+            res->failed++;
+        }
+    }
+
+    for (int i = 0; i < MIXED_LIVE_OBJECTS; ++i) {
+        if (slab) slab_free(slab, live[i]); else free(live[i]);
+    }
+}
+
+static void print_mixed(const char* label, const MixedResult* res) {
+    report_latency("slab", label, "alloc", &res->alloc);
+    report_latency("slab", label, "free", &res->free);
+    if (res->failed) info("%s: %ld allocations failed\n", label, res->failed);
+}
+
+void benchmark_slab() {
+    info("Benchmarking mixed-size workload (%d..%d bytes, %d live objects)...\n",
+           SLAB_MIN_SIZE, SLAB_MAX_SIZE, MIXED_LIVE_OBJECTS);
+    size_t* sizes = (size_t*)malloc(BENCH_ITERATIONS * sizeof(size_t));
+    SlabAllocator* slab = slab_create(SLAB_CLASS_CAPACITY, POOL_FLAG_PREFAULT);
+    if (!sizes || !slab) {
+        printf("Failed to create slab allocator\n");
+        free(sizes);
+        slab_destroy(slab);
+        return;
+    }
+    fill_mixed_sizes(sizes, BENCH_ITERATIONS);
+
+    static MixedResult res;
+    run_mixed(sizes, NULL, &res);
+    print_mixed("malloc", &res);
+    run_mixed(sizes, slab, &res);
+    print_mixed("slab", &res);
+
+    slab_destroy(slab);
+    free(sizes);
+}
+
+typedef struct {
+    volatile long* counter;
+    int cpu;
+} SharingArgs;
+
+static void* sharing_writer(void* arg) {
+    SharingArgs* args = (SharingArgs*)arg;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(args->cpu, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+
+    for (long i = 0; i < SHARING_WRITES; ++i) {
+        (*args->counter)++;
+    }
+    return NULL;
+}
+
+// Два закрепленных за разными ядрами потока пишут каждый в свой блок,
+// выделенный из пула подряд. Без выравнивания блоки делят кэш-линию,
+// и линия непрерывно перебрасывается между ядрами
+static void benchmark_sharing_layout(const char* label, size_t alignment, int cpu_a, int cpu_b) {
+    PoolOptions options = { .alignment = alignment };
+    MemoryPool* pool = pool_create_ex(SHARING_BLOCK_SIZE, 2, &options);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+    SharingArgs args[2] = {
+        { (volatile long*)pool_alloc(pool), cpu_a },
+        { (volatile long*)pool_alloc(pool), cpu_b },
+    };
+    *args[0].counter = 0;
+    *args[1].counter = 0;
+
+    struct timespec start, end;
+    pthread_t threads[2];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < 2; ++t) {
+        pthread_create(&threads[t], NULL, sharing_writer, &args[t]);
+    }
+    for (int t = 0; t < 2; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long distance = (long)((char*)args[0].counter - (char*)args[1].counter);
+    if (distance < 0) distance = -distance;
+    double elapsed_s = timespec_diff_ns(start, end) / 1e9;
+    info("%-11s block stride: %4zu B  distance: %4ld B  time: %6.3f s  writes/sec: %12.0f\n",
+           label, pool_block_size(pool), distance, elapsed_s, 2.0 * SHARING_WRITES / elapsed_s);
+
+    pool_free(pool, (void*)args[0].counter);
+    pool_free(pool, (void*)args[1].counter);
+    pool_destroy(pool);
+}
+
+void benchmark_false_sharing() {
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int cpu_b = cpus > 1 ? 1 : 0;
+    info("Benchmarking false sharing (threads pinned to CPU 0 and CPU %d)...\n", cpu_b);
+    if (cpu_b == 0) {
+        info("Only one CPU online: both threads share a core, no cache-line ping-pong expected\n");
+    }
+    benchmark_sharing_layout("packed", 0, 0, cpu_b);
+    benchmark_sharing_layout("cache-line", POOL_ALIGN_CACHE_LINE, 0, cpu_b);
+}
+
+// Время выделения и освобождения пакета из burst блоков:
+// поблочными вызовами и одним вызовом pool_alloc_bulk/pool_free_bulk
+static void benchmark_burst(const char* label, unsigned flags, size_t burst) {
+    PoolOptions options = { .flags = flags };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, BULK_POOL_BLOCKS, &options);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+    void* ptrs[BULK_MAX_BURST];
+    int bursts = BENCH_ITERATIONS / (int)burst;
+    char variant[32];
+    snprintf(variant, sizeof(variant), "%s-%zu", label, burst);
+
+    for (int bulk = 0; bulk <= 1; ++bulk) {
+        static LatencyHist hist;
+        hist_init(&hist);
+        for (int b = 0; b < bursts; ++b) {
+            uint64_t start = timer_start();
+            if (bulk) {
+                pool_alloc_bulk(pool, ptrs, burst);
+                pool_free_bulk(pool, ptrs, burst);
+            } else {
+                for (size_t i = 0; i < burst; ++i) ptrs[i] = pool_alloc(pool);
+                for (size_t i = 0; i < burst; ++i) pool_free(pool, ptrs[i]);
+            }
+            uint64_t stop = timer_stop();
+            hist_record(&hist, timer_elapsed_ns(start, stop));
+        }
+        report_latency("bulk", variant, bulk ? "bulk" : "per-block", &hist);
+    }
+
+    pool_destroy(pool);
+}
+
+void benchmark_bulk() {
+    info("Benchmarking per-block vs bulk alloc/free (alloc + free of one burst)...\n");
+    for (size_t burst = 32; burst <= BULK_MAX_BURST; burst *= 2) {
+        benchmark_burst("pointer", 0, burst);
+        benchmark_burst("index", POOL_FLAG_INDEX_LIST, burst);
+        benchmark_burst("mt", POOL_FLAG_THREAD_SAFE, burst);
+    }
+}
+
+// Цикл pool_alloc -> pool_free одного блока. Запускается в обычной
+// (task3_benchmark) и проверяемой (task3_benchmark_debug) сборках:
+// в обычной проверки исключены компилятором и задержка не меняется
+void benchmark_checked() {
+#ifdef MEMPOOL_DEBUG
+    const char* build = "checked";
+#else
+    const char* build = "release";
+#endif
+    info("Benchmarking pool_alloc/pool_free pairs, build: %s\n", build);
+
+    MemoryPool* pool = pool_create(BLOCK_SIZE, BULK_POOL_BLOCKS);
+    if (!pool) {
+        printf("Failed to create memory pool\n");
+        return;
+    }
+    static LatencyHist hist;
+    hist_init(&hist);
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        uint64_t start = timer_start();
+        void* block = pool_alloc(pool);
+        pool_free(pool, block);
+        uint64_t stop = timer_stop();
+        hist_record(&hist, timer_elapsed_ns(start, stop));
+    }
+    info("block stride: %zu B\n", pool_block_size(pool));
+    report_latency("checked", build, "alloc+free", &hist);
+    pool_destroy(pool);
+}
+
+// Всплески по GROW_BURST выделений с паузами между ними, пока не будет
+// удержано GROW_TARGET_BLOCKS блоков — в 16 раз больше начального размера
+static void benchmark_grow_mode(const char* label, unsigned flags) {
+    PoolOptions options = {
+        .flags = flags | POOL_FLAG_PREFAULT,
+        .max_block_count = GROW_MAX_BLOCKS,
+        .grow_watermark = GROW_INITIAL_BLOCKS / 2,
+        .grow_chunk = GROW_INITIAL_BLOCKS,
+    };
+    MemoryPool* pool = pool_create_ex(BLOCK_SIZE, GROW_INITIAL_BLOCKS, &options);
+    void** ptrs = (void**)malloc(GROW_TARGET_BLOCKS * sizeof(void*));
+    if (!pool || !ptrs) {
+        printf("Failed to create growable pool\n");
+        pool_destroy(pool);
+        free(ptrs);
+        return;
+    }
+
+    struct timespec pause = { 0, GROW_PAUSE_NS };
+    static LatencyHist hist;
+    hist_init(&hist);
+    long failed = 0;
+    int held = 0;
+    while (held < GROW_TARGET_BLOCKS) {
+        for (int i = 0; i < GROW_BURST && held < GROW_TARGET_BLOCKS; ++i) {
+            uint64_t start = timer_start();
+            void* block = pool_alloc(pool);
+            uint64_t stop = timer_stop();
+            hist_record(&hist, timer_elapsed_ns(start, stop));
+            if (block) {
+                *(volatile char*)block = 1;
+                ptrs[held++] = block;
+            } else {
+                failed++;
+            }
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &pause, NULL);
+    }
+
+    PoolStats stats;
+    pool_stats(pool, &stats);
+    info("%-4s initial: %d  grown to: %zu blocks  failed: %ld\n",
+         label, GROW_INITIAL_BLOCKS, stats.block_count, failed);
+    report_latency("grow", label, "alloc", &hist);
+
+    for (int i = 0; i < held; ++i) {
+        pool_free(pool, ptrs[i]);
+    }
+    free(ptrs);
+    pool_destroy(pool);
+}
+
+void benchmark_grow() {
+    info("Benchmarking growable pool (bursts of %d allocs, %d us pauses, watermark %d)...\n",
+           GROW_BURST, GROW_PAUSE_NS / 1000, GROW_INITIAL_BLOCKS / 2);
+    benchmark_grow_mode("st", 0);
+    benchmark_grow_mode("mt", POOL_FLAG_THREAD_SAFE);
+}
+
+// Режимы бенчмарка, выбираемые аргументами командной строки
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} BenchMode;
+
+static const BenchMode bench_modes[] = {
+    { "malloc",    benchmark_malloc },
+    { "pool",      benchmark_mempool },
+    { "hugepages", benchmark_hugepages },
+    { "slab",      benchmark_slab },
+    { "sharing",   benchmark_false_sharing },
+    { "bulk",      benchmark_bulk },
+    { "checked",   benchmark_checked },
+    { "grow",      benchmark_grow },
+};
+
+#define NUM_BENCH_MODES (sizeof(bench_modes) / sizeof(bench_modes[0]))
+
+int main(int argc, char* argv[]) {
+    // Опции: --tsc (замер тактами TSC), --format=text|csv|json.
+    // Остальные аргументы — режимы, выполняемые по порядку
+    TimerSource source = TIMER_CLOCK;
+    size_t modes[argc + 1];         // +1: без аргументов выполняются два режима
+    int mode_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--tsc") == 0) {
+            source = TIMER_TSC;
+        } else if (strcmp(argv[i], "--format=text") == 0) {
+            output_format = OUTPUT_TEXT;
+        } else if (strcmp(argv[i], "--format=csv") == 0) {
+            output_format = OUTPUT_CSV;
+        } else if (strcmp(argv[i], "--format=json") == 0) {
+            output_format = OUTPUT_JSON;
+        } else {
+            size_t m = 0;
+            while (m < NUM_BENCH_MODES && strcmp(argv[i], bench_modes[m].name) != 0) ++m;
+            if (m == NUM_BENCH_MODES) {
+                fprintf(stderr, "Unknown mode '%s'. Options: --tsc --format=text|csv|json. Modes:", argv[i]);
+                for (m = 0; m < NUM_BENCH_MODES; ++m) fprintf(stderr, " %s", bench_modes[m].name);
+                fprintf(stderr, "\n");
+                return 1;
+            }
+            modes[mode_count++] = m;
+        }
+    }
+
     if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
         perror("mlockall failed. Try with sudo");
         return 1;
     }
 
-    benchmark_malloc();
-    printf("\n");
-    benchmark_mempool();
+    if (timer_init(source) != 0) {
+        fprintf(stderr, "Invariant TSC not available, falling back to clock_gettime\n");
+    }
+    uname(&host_info);
+    info("Timer: %s, overhead %.1f ns subtracted from every sample\n",
+         timer_source_name(), timer_overhead_ns());
+    if (output_format == OUTPUT_CSV) print_csv_header();
+
+    // Без режимов — исходное сравнение malloc и пула
+    if (mode_count == 0) {
+        modes[mode_count++] = 0;
+        modes[mode_count++] = 1;
+    }
+
+    for (int i = 0; i < mode_count; ++i) {
+        info("\n");
+        bench_modes[modes[i]].run();
+    }
 
     return 0;
 }
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "mempool.h"
+
+#define BENCH_ROUNDS 2000
+#define BATCH_SIZE 64
+#define BLOCK_SIZE 128
+#define MAX_THREADS POOL_MAX_THREADS
+
+long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+// Общие данные одного прогона
+typedef struct {
+    MemoryPool* pool;
+    int thread_count;
+    pthread_barrier_t barrier;
+    void* slots[MAX_THREADS][BATCH_SIZE]; // Блоки, выделенные каждым потоком в текущем раунде
+} BenchContext;
+
+typedef struct {
+    BenchContext* ctx;
+    int id;
+    long long max_alloc_latency;
+    long long max_free_latency;
+    long failed_allocs;
+} WorkerArgs;
+
+// Каждый раунд поток выделяет BATCH_SIZE блоков, а после барьера
+// освобождает блоки соседнего потока — так проверяется pool_free
+// из потока, отличного от выделившего блок
+static void* worker_func(void* arg) {
+    WorkerArgs* args = (WorkerArgs*)arg;
+    BenchContext* ctx = args->ctx;
+    int neighbour = (args->id + 1) % ctx->thread_count;
+    struct timespec start, end;
+
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (int i = 0; i < BATCH_SIZE; ++i) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            void* block = pool_alloc(ctx->pool);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            long long latency = timespec_diff_ns(start, end);
+            if (latency > args->max_alloc_latency) args->max_alloc_latency = latency;
+            if (!block) args->failed_allocs++;
+            ctx->slots[args->id][i] = block;
+        }
+
+        pthread_barrier_wait(&ctx->barrier);
+
+        for (int i = 0; i < BATCH_SIZE; ++i) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            pool_free(ctx->pool, ctx->slots[neighbour][i]);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            long long latency = timespec_diff_ns(start, end);
+            if (latency > args->max_free_latency) args->max_free_latency = latency;
+        }
+
+        pthread_barrier_wait(&ctx->barrier);
+    }
+
+    pool_thread_flush(ctx->pool);
+    return NULL;
+}
+
+static int run_benchmark(BenchContext* ctx, int thread_count) {
+    pthread_t threads[MAX_THREADS];
+    WorkerArgs args[MAX_THREADS];
+    struct timespec start, end;
+
+    PoolOptions options = { .flags = POOL_FLAG_THREAD_SAFE };
+    // Запас на кэши потоков: в каждом может лежать до POOL_CACHE_SIZE блоков
+    size_t block_count = (size_t)thread_count * (BATCH_SIZE + POOL_CACHE_SIZE);
+    ctx->pool = pool_create_ex(BLOCK_SIZE, block_count, &options);
+    if (!ctx->pool) {
+        printf("Failed to create memory pool\n");
+        return -1;
+    }
+    ctx->thread_count = thread_count;
+    pthread_barrier_init(&ctx->barrier, NULL, (unsigned)thread_count);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < thread_count; ++t) {
+        args[t] = (WorkerArgs){ .ctx = ctx, .id = t };
+        if (pthread_create(&threads[t], NULL, worker_func, &args[t]) != 0) {
+            perror("pthread_create failed");
+            return -1;
+        }
+    }
+
+    long long max_alloc = 0, max_free = 0;
+    long failed = 0;
+    for (int t = 0; t < thread_count; ++t) {
+        pthread_join(threads[t], NULL);
+        if (args[t].max_alloc_latency > max_alloc) max_alloc = args[t].max_alloc_latency;
+        if (args[t].max_free_latency > max_free) max_free = args[t].max_free_latency;
+        failed += args[t].failed_allocs;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    PoolStats stats;
+    pool_stats(ctx->pool, &stats);
+
+    double elapsed_s = timespec_diff_ns(start, end) / 1e9;
+    double total_allocs = (double)thread_count * BENCH_ROUNDS * BATCH_SIZE;
+    printf("%7d\t%14.0f\t%15lld\t%14lld\t%6ld\t%5zu/%zu\n",
+           thread_count, total_allocs / elapsed_s, max_alloc, max_free, failed,
+           stats.high_water, stats.block_count);
+
+    pthread_barrier_destroy(&ctx->barrier);
+    pool_destroy(ctx->pool);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+    }
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed. Try with sudo");
+        return 1;
+    }
+
+    printf("Benchmarking thread-safe memory pool (1..%d threads, %d allocs per thread)\n",
+           max_threads, BENCH_ROUNDS * BATCH_SIZE);
+    printf("Threads\tAllocs/sec\tMax alloc (ns)\tMax free (ns)\tFailed\tHigh water\n");
+
+    BenchContext* ctx = (BenchContext*)malloc(sizeof(BenchContext));
+    if (!ctx) {
+        perror("malloc failed");
+        return 1;
+    }
+    for (int n = 1; n <= max_threads; ++n) {
+        if (run_benchmark(ctx, n) != 0) break;
+    }
+    free(ctx);
+
+    return 0;
+}
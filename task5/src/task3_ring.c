@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include "mempool.h"
+#include "ring.h"
+
+#define RING_CAPACITY 1024
+#define BATCH_SIZE 32
+#define BLOCK_SIZE 64
+#define MAX_PRODUCERS 4
+#define DEFAULT_MESSAGES 1000000
+#define LATENCY_MESSAGES 100000
+
+long long timespec_diff_ns(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Сообщение, записываемое производителем в блок пула
+typedef struct {
+    long long sent_ns;
+    long seq;
+} Message;
+
+typedef struct {
+    BlockRing* ring;
+    MemoryPool* pool;
+    int producers;
+    long messages;      // Сообщений на одного производителя
+    int ping;           // 1: следующее сообщение отправляется только после приема предыдущего
+    _Atomic long consumed;
+    long long* samples; // Задержки доставки, заполняет потребитель
+    long sample_count;
+    long long max_latency;
+} RingBench;
+
+typedef struct {
+    RingBench* bench;
+    int cpu;
+} ThreadArgs;
+
+static void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        printf("Warning: failed to pin thread to CPU %d\n", cpu);
+    }
+}
+
+static void* producer_func(void* arg) {
+    ThreadArgs* args = (ThreadArgs*)arg;
+    RingBench* bench = args->bench;
+    void* blocks[BATCH_SIZE];
+    pin_to_cpu(args->cpu);
+
+    long sent = 0;
+    while (sent < bench->messages) {
+        size_t batch = bench->ping ? 1 : BATCH_SIZE;
+        if ((long)batch > bench->messages - sent) batch = (size_t)(bench->messages - sent);
+
+        if (bench->ping) {
+            // Ждем, пока потребитель примет предыдущее сообщение
+            while (atomic_load_explicit(&bench->consumed, memory_order_acquire) < sent) {
+                sched_yield();
+            }
+        }
+
+        size_t got = pool_alloc_bulk(bench->pool, blocks, batch);
+        if (got == 0) {
+            sched_yield(); // Блоки еще не вернулись от потребителя
+            continue;
+        }
+        long long stamp = now_ns();
+        for (size_t i = 0; i < got; ++i) {
+            Message* msg = (Message*)blocks[i];
+            msg->sent_ns = stamp;
+            msg->seq = sent + (long)i;
+        }
+
+        size_t done = 0;
+        while (done < got) {
+            size_t n = ring_enqueue_bulk(bench->ring, bench->pool, blocks + done, got - done);
+            if (n == 0) sched_yield();
+            done += n;
+        }
+        sent += (long)got;
+    }
+
+    pool_thread_flush(bench->pool);
+    return NULL;
+}
+
+static void record_latency(void* block, void* ctx) {
+    RingBench* bench = (RingBench*)ctx;
+    long long latency = now_ns() - ((Message*)block)->sent_ns;
+    if (latency > bench->max_latency) bench->max_latency = latency;
+    if (bench->sample_count < LATENCY_MESSAGES) {
+        bench->samples[bench->sample_count++] = latency;
+    }
+}
+
+static void* consumer_func(void* arg) {
+    ThreadArgs* args = (ThreadArgs*)arg;
+    RingBench* bench = args->bench;
+    pin_to_cpu(args->cpu);
+
+    long total = bench->messages * bench->producers;
+    long consumed = 0;
+    while (consumed < total) {
+        size_t n = ring_consume(bench->ring, record_latency, bench, BATCH_SIZE);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        consumed += (long)n;
+        atomic_store_explicit(&bench->consumed, consumed, memory_order_release);
+    }
+
+    pool_thread_flush(bench->pool);
+    return NULL;
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static int run_benchmark(const char* name, RingMode mode, int producers, long messages,
+                         int ping, long long* samples) {
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    RingBench bench = {
+        .producers = producers,
+        .messages = messages,
+        .ping = ping,
+        .samples = samples,
+    };
+    atomic_init(&bench.consumed, 0);
+
+    bench.ring = ring_create(RING_CAPACITY, mode);
+    PoolOptions options = { .flags = POOL_FLAG_THREAD_SAFE };
+    // Запас на пакеты в пути и кэши потоков производителей и потребителя
+    size_t block_count = RING_CAPACITY + (size_t)(producers + 1) * (BATCH_SIZE + 2 * POOL_CACHE_SIZE);
+    bench.pool = pool_create_ex(BLOCK_SIZE, block_count, &options);
+    if (!bench.ring || !bench.pool) {
+        printf("Failed to create ring or memory pool\n");
+        ring_destroy(bench.ring);
+        pool_destroy(bench.pool);
+        return -1;
+    }
+
+    // Потребитель на CPU 0, производители на следующих ядрах
+    pthread_t consumer, threads[MAX_PRODUCERS];
+    ThreadArgs consumer_args = { .bench = &bench, .cpu = 0 };
+    ThreadArgs args[MAX_PRODUCERS];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (pthread_create(&consumer, NULL, consumer_func, &consumer_args) != 0) {
+        perror("pthread_create failed");
+        return -1;
+    }
+    for (int p = 0; p < producers; ++p) {
+        args[p] = (ThreadArgs){ .bench = &bench, .cpu = (p + 1) % cpus };
+        if (pthread_create(&threads[p], NULL, producer_func, &args[p]) != 0) {
+            perror("pthread_create failed");
+            return -1;
+        }
+    }
+    for (int p = 0; p < producers; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+    pthread_join(consumer, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed_s = timespec_diff_ns(start, end) / 1e9;
+    double total = (double)messages * producers;
+    qsort(samples, (size_t)bench.sample_count, sizeof(long long), compare_ll);
+    long long p50 = bench.sample_count ? samples[bench.sample_count / 2] : 0;
+    long long p99 = bench.sample_count ? samples[bench.sample_count * 99 / 100] : 0;
+
+    PoolStats stats;
+    pool_stats(bench.pool, &stats);
+    printf("%-22s\t%12.0f\t%9lld\t%9lld\t%12lld\t%zu/%zu\n",
+           name, total / elapsed_s, p50, p99, bench.max_latency, stats.in_use, stats.block_count);
+
+    ring_destroy(bench.ring);
+    pool_destroy(bench.pool);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long messages = DEFAULT_MESSAGES;
+    if (argc > 1) {
+        messages = atol(argv[1]);
+    }
+    if (messages < 1) messages = 1;
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed. Try with sudo");
+        return 1;
+    }
+
+    long long* samples = (long long*)malloc(LATENCY_MESSAGES * sizeof(long long));
+    if (!samples) {
+        perror("malloc failed");
+        return 1;
+    }
+
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 2) {
+        printf("Warning: only %d CPU online, producer and consumer share a core\n", cpus);
+    }
+
+    long ping_messages = messages < LATENCY_MESSAGES ? messages : LATENCY_MESSAGES;
+    printf("Ring buffer benchmark (capacity %d, batch %d, %ld messages per producer)\n",
+           RING_CAPACITY, BATCH_SIZE, messages);
+    printf("Mode\t\t\t\tMsgs/sec\tp50 (ns)\tp99 (ns)\tMax (ns)\tIn use\n");
+
+    // Потоковый режим: задержка включает ожидание в очереди
+    run_benchmark("SPSC stream", RING_SPSC, 1, messages, 0, samples);
+    run_benchmark("MPSC stream, 1 prod", RING_MPSC, 1, messages, 0, samples);
+    run_benchmark("MPSC stream, 2 prod", RING_MPSC, 2, messages, 0, samples);
+    run_benchmark("MPSC stream, 4 prod", RING_MPSC, MAX_PRODUCERS, messages, 0, samples);
+    // Режим пинг: очередь пуста, задержка — чистая передача между ядрами
+    run_benchmark("SPSC one-way", RING_SPSC, 1, ping_messages, 1, samples);
+    run_benchmark("MPSC one-way", RING_MPSC, 1, ping_messages, 1, samples);
+
+    free(samples);
+    return 0;
+}
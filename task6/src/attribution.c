@@ -0,0 +1,300 @@
+#define _GNU_SOURCE
+#include "attribution.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define MSR_SMI_COUNT 0x34
+#define RECENT_EVENTS 10
+
+// Прочитать файл /proc целиком в буфер; длина или -1
+static ssize_t read_proc(int fd, char *buf, size_t size) {
+    size_t used = 0;
+    if (lseek(fd, 0, SEEK_SET) != 0) return -1;
+    while (used + 1 < size) {
+        ssize_t n = read(fd, buf + used, size - 1 - used);
+        if (n < 0) return -1;
+        if (n == 0) break;
+        used += (size_t)n;
+    }
+    buf[used] = '\0';
+    return (ssize_t)used;
+}
+
+// Номер столбца ядра cpu в заголовке "CPU0 CPU1 ..."
+static int cpu_column(const char *header, int cpu) {
+    int column = 0;
+    const char *p = header;
+    while (*p && *p != '\n') {
+        while (*p == ' ') p++;
+        if (strncmp(p, "CPU", 3) == 0) {
+            if (atoi(p + 3) == cpu) return column;
+            column++;
+        }
+        while (*p && *p != ' ' && *p != '\n') p++;
+    }
+    return -1;
+}
+
+// Разобрать таблицу /proc в table->current (и имена строк)
+static int read_table(ProcTable *table, char *buf, int cpu) {
+    if (table->fd < 0 || read_proc(table->fd, buf, ATTR_PROC_BUF) < 0) return -1;
+    int column = cpu_column(buf, cpu);
+    char *line = strchr(buf, '\n');
+    int row = 0;
+    while (line && column >= 0 && row < ATTR_MAX_SOURCES) {
+        line++;
+        char *colon = strchr(line, ':');
+        char *eol = strchr(line, '\n');
+        if (!colon || (eol && colon > eol)) break;
+
+        char *name = line;
+        while (*name == ' ') name++;
+        size_t len = (size_t)(colon - name);
+        if (len >= ATTR_NAME_LEN) len = ATTR_NAME_LEN - 1;
+
+        // Строки вроде ERR/MIS содержат одно число: столбец может отсутствовать
+        uint64_t value = 0;
+        char *p = colon + 1;
+        for (int c = 0; c <= column; c++) {
+            char *end;
+            unsigned long long v = strtoull(p, &end, 10);
+            if (end == p || (eol && end > eol)) {
+                v = 0;
+                c = column;
+            }
+            value = v;
+            p = end;
+        }
+
+        if (row >= table->count || strncmp(table->names[row], name, len) != 0 ||
+            table->names[row][len] != '\0') {
+            // Новая или переставленная строка: прироста пока нет
+            memcpy(table->names[row], name, len);
+            table->names[row][len] = '\0';
+            table->values[row] = value;
+            table->hits[row] = table->totals[row] = 0;
+        }
+        table->current[row] = value;
+        row++;
+        line = eol;
+    }
+    table->count = row;
+    return 0;
+}
+
+static uint64_t read_smi(int fd) {
+    uint64_t value = 0;
+    if (fd < 0 || pread(fd, &value, sizeof(value), MSR_SMI_COUNT) != sizeof(value)) return 0;
+    return value;
+}
+
+static void read_ctx(long *voluntary, long *involuntary) {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    *voluntary = usage.ru_nvcsw;
+    *involuntary = usage.ru_nivcsw;
+}
+
+static void commit_baseline(ProcTable *table) {
+    memcpy(table->values, table->current, table->count * sizeof(uint64_t));
+}
+
+int attr_init(Attribution *attr, int cpu, uint64_t threshold_ns, size_t capacity,
+              long long refresh_ns, long long start_ns) {
+    memset(attr, 0, sizeof(*attr));
+    attr->irq.fd = attr->softirq.fd = attr->msr_fd = -1;
+    attr->cpu = cpu;
+    attr->threshold_ns = threshold_ns;
+    attr->refresh_ns = refresh_ns > 0 ? refresh_ns : 0;
+    attr->start_ns = start_ns;
+    attr->capacity = capacity ? capacity : ATTR_DEFAULT_RING;
+    attr->buf = malloc(ATTR_PROC_BUF);
+    attr->ring = calloc(attr->capacity, sizeof(AttrEvent));
+    if (!attr->buf || !attr->ring) {
+        attr_destroy(attr);
+        return -1;
+    }
+
+    attr->irq.fd = open("/proc/interrupts", O_RDONLY);
+    attr->softirq.fd = open("/proc/softirqs", O_RDONLY);
+    char path[64];
+    snprintf(path, sizeof(path), "/dev/cpu/%d/msr", cpu);
+    attr->msr_fd = open(path, O_RDONLY);
+    // MSR_SMI_COUNT есть только у Intel: неудачное чтение — SMI неизвестны
+    if (attr->msr_fd >= 0 && pread(attr->msr_fd, &attr->smi_base, sizeof(attr->smi_base),
+                                   MSR_SMI_COUNT) != sizeof(attr->smi_base)) {
+        close(attr->msr_fd);
+        attr->msr_fd = -1;
+    }
+
+    attr_refresh(attr, start_ns);
+    return 0;
+}
+
+void attr_refresh(Attribution *attr, long long now_ns) {
+    // Без привязки поток мог переехать: снимок берется для текущего ядра
+    int cpu = sched_getcpu();
+    if (cpu >= 0) attr->cpu = cpu;
+    if (read_table(&attr->irq, attr->buf, attr->cpu) == 0) commit_baseline(&attr->irq);
+    if (read_table(&attr->softirq, attr->buf, attr->cpu) == 0) commit_baseline(&attr->softirq);
+    attr->smi_base = read_smi(attr->msr_fd);
+    read_ctx(&attr->ctx_vol_base, &attr->ctx_invol_base);
+    attr->baseline_ns = now_ns;
+    attr->next_refresh_ns = now_ns + attr->refresh_ns;
+}
+
+// Прирост таблицы с базового снимка: сумма и источник с наибольшим приростом
+static uint64_t table_delta(ProcTable *table, char *top) {
+    uint64_t sum = 0, best = 0;
+    top[0] = '\0';
+    for (int i = 0; i < table->count; i++) {
+        if (table->current[i] <= table->values[i]) continue;
+        uint64_t delta = table->current[i] - table->values[i];
+        sum += delta;
+        table->hits[i]++;
+        table->totals[i] += delta;
+        if (delta > best) {
+            best = delta;
+            memcpy(top, table->names[i], ATTR_NAME_LEN);
+        }
+    }
+    commit_baseline(table);
+    return sum;
+}
+
+void attr_capture(Attribution *attr, uint64_t index, uint64_t latency_ns, long long now_ns,
+                  int cpu_start, int cpu_end) {
+    AttrEvent *event = &attr->ring[attr->events % attr->capacity];
+    attr->events++;
+
+    memset(event, 0, sizeof(*event));
+    event->index = index;
+    event->latency_ns = latency_ns;
+    event->time_ns = now_ns - attr->start_ns;
+    event->window_us = (uint32_t)((now_ns - attr->baseline_ns) / 1000);
+    event->cpu = (int16_t)cpu_end;
+    event->migrated = cpu_start != cpu_end;
+
+    if (cpu_end < 0 || cpu_end == attr->cpu) {
+        read_table(&attr->irq, attr->buf, attr->cpu);
+        read_table(&attr->softirq, attr->buf, attr->cpu);
+        event->irqs = (uint32_t)table_delta(&attr->irq, event->top_irq);
+        event->softirqs = (uint32_t)table_delta(&attr->softirq, event->top_softirq);
+    } else {
+        // Базовый снимок снят в столбце другого ядра: прирост не сравним,
+        // начинаем новое окно на текущем ядре
+        attr->cpu = cpu_end;
+        if (read_table(&attr->irq, attr->buf, attr->cpu) == 0) commit_baseline(&attr->irq);
+        if (read_table(&attr->softirq, attr->buf, attr->cpu) == 0) commit_baseline(&attr->softirq);
+        event->migrated = 1;
+    }
+
+    long vol, invol;
+    read_ctx(&vol, &invol);
+    event->ctx_voluntary = (uint16_t)(vol - attr->ctx_vol_base);
+    event->ctx_involuntary = (uint16_t)(invol - attr->ctx_invol_base);
+    attr->ctx_vol_base = vol;
+    attr->ctx_invol_base = invol;
+
+    if (attr->msr_fd >= 0) {
+        uint64_t smi = read_smi(attr->msr_fd);
+        event->smi = (int16_t)(smi - attr->smi_base);
+        attr->smi_base = smi;
+    } else {
+        event->smi = -1;
+    }
+
+    int explained = 0;
+    if (event->irqs) { attr->with_irq++; explained = 1; }
+    if (event->softirqs) { attr->with_softirq++; explained = 1; }
+    if (event->ctx_voluntary || event->ctx_involuntary) { attr->with_ctx++; explained = 1; }
+    if (event->smi > 0) { attr->with_smi++; explained = 1; }
+    if (event->migrated) { attr->with_migration++; explained = 1; }
+    if (!explained) attr->unexplained++;
+
+    attr->baseline_ns = now_ns;
+    attr->next_refresh_ns = now_ns + attr->refresh_ns;
+}
+
+static void print_cause(const char *name, uint64_t count, uint64_t total) {
+    printf("  %-18s %10llu  %6.1f%%\n", name, (unsigned long long)count,
+           total ? count * 100.0 / total : 0.0);
+}
+
+// Источники, чаще всего сопровождавшие выбросы
+static void print_top_sources(const char *title, const ProcTable *table) {
+    printf("%s:", title);
+    int shown[5];
+    int count = 0;
+    for (int n = 0; n < 5; n++) {
+        int best = -1;
+        for (int i = 0; i < table->count; i++) {
+            int used = 0;
+            for (int j = 0; j < count; j++) used |= shown[j] == i;
+            if (used || !table->hits[i]) continue;
+            if (best < 0 || table->hits[i] > table->hits[best]) best = i;
+        }
+        if (best < 0) break;
+        shown[count++] = best;
+        printf(" %s (%llu outliers, +%llu)", table->names[best],
+               (unsigned long long)table->hits[best], (unsigned long long)table->totals[best]);
+    }
+    printf("%s\n", count ? "" : " none");
+}
+
+void attr_print_summary(const Attribution *attr) {
+    uint64_t total = attr->events;
+    uint64_t logged = total < attr->capacity ? total : attr->capacity;
+    printf("\n--- Outlier Attribution (threshold %llu ns) ---\n", (unsigned long long)attr->threshold_ns);
+    printf("Outliers: %llu (log holds %llu, overwritten %llu)\n", (unsigned long long)total,
+           (unsigned long long)logged, (unsigned long long)(total - logged));
+    if (attr->refresh_ns > 0) {
+        printf("Window: up to %lld us before each outlier (counts include timer ticks in it)\n",
+               attr->refresh_ns / 1000);
+    } else {
+        printf("Window: the outlier sample only (baseline taken before every sample)\n");
+    }
+    if (!total) return;
+    printf("  %-18s %10s  %7s\n", "Cause", "Outliers", "Share");
+    print_cause("hardware IRQ", attr->with_irq, total);
+    print_cause("softirq", attr->with_softirq, total);
+    print_cause("context switch", attr->with_ctx, total);
+    if (attr->msr_fd >= 0) {
+        print_cause("SMI", attr->with_smi, total);
+    } else {
+        printf("  %-18s %10s\n", "SMI", "n/a");
+    }
+    print_cause("migration", attr->with_migration, total);
+    print_cause("unexplained", attr->unexplained, total);
+    print_top_sources("Top IRQ sources", &attr->irq);
+    print_top_sources("Top softirqs", &attr->softirq);
+
+    printf("\nMost recent outliers:\n");
+    printf("%12s %12s %10s %8s %4s %6s %-8s %6s %-8s %5s %5s %4s %3s\n", "Sample", "Latency ns",
+           "At s", "Win us", "CPU", "IRQs", "Top IRQ", "SoftIR", "Top soft", "Vcsw", "Icsw", "SMI", "Mig");
+    uint64_t first = total - (logged < RECENT_EVENTS ? logged : RECENT_EVENTS);
+    for (uint64_t i = first; i < total; i++) {
+        const AttrEvent *e = &attr->ring[i % attr->capacity];
+        printf("%12llu %12llu %10.3f %8u %4d %6u %-8s %6u %-8s %5u %5u %4d %3s\n",
+               (unsigned long long)e->index, (unsigned long long)e->latency_ns, e->time_ns / 1e9,
+               e->window_us, e->cpu, e->irqs, e->top_irq[0] ? e->top_irq : "-", e->softirqs,
+               e->top_softirq[0] ? e->top_softirq : "-", e->ctx_voluntary, e->ctx_involuntary,
+               e->smi, e->migrated ? "yes" : "no");
+    }
+}
+
+void attr_destroy(Attribution *attr) {
+    if (attr->irq.fd >= 0) close(attr->irq.fd);
+    if (attr->softirq.fd >= 0) close(attr->softirq.fd);
+    if (attr->msr_fd >= 0) close(attr->msr_fd);
+    free(attr->ring);
+    free(attr->buf);
+    attr->ring = NULL;
+    attr->buf = NULL;
+    attr->irq.fd = attr->softirq.fd = attr->msr_fd = -1;
+}
@@ -0,0 +1,117 @@
+#ifndef ATTRIBUTION_H
+#define ATTRIBUTION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ATTR_MAX_SOURCES 512     // Строк /proc/interrupts или /proc/softirqs
+#define ATTR_NAME_LEN 8
+#define ATTR_PROC_BUF (256 * 1024)
+#define ATTR_DEFAULT_RING 4096
+#define ATTR_DEFAULT_WINDOW_US 0 // 0 — базовый снимок перед каждой выборкой
+
+/**
+ * @brief Событие журнала: одна медленная выборка и ее возможные причины.
+ *
+ * Счетчики прерываний, softirq, переключений контекста и SMI — приросты
+ * за окно атрибуции (window_us), которое заканчивается выборкой. Окно
+ * должно быть коротким: за 100 мс на ядре набегают десятки тиков
+ * локального таймера, и прерывание нашлось бы почти у каждого выброса.
+ */
+typedef struct {
+    uint64_t index;                 // Номер выборки
+    uint64_t latency_ns;
+    int64_t time_ns;                // Время от начала прогона
+    uint32_t window_us;
+    uint32_t irqs;                  // Аппаратные прерывания на ядре
+    uint32_t softirqs;
+    uint16_t ctx_voluntary;
+    uint16_t ctx_involuntary;
+    int16_t smi;                    // -1 — MSR недоступен
+    int16_t cpu;                    // Ядро в конце выборки
+    uint8_t migrated;               // Выборка началась на другом ядре
+    char top_irq[ATTR_NAME_LEN];    // Источник с наибольшим приростом
+    char top_softirq[ATTR_NAME_LEN];
+} AttrEvent;
+
+/**
+ * @brief Счетчики одного файла /proc (interrupts или softirqs) для ядра.
+ */
+typedef struct {
+    int fd;
+    int count;
+    char names[ATTR_MAX_SOURCES][ATTR_NAME_LEN];
+    uint64_t values[ATTR_MAX_SOURCES];  // Значения на момент базового снимка
+    uint64_t current[ATTR_MAX_SOURCES]; // Последнее чтение
+    uint64_t hits[ATTR_MAX_SOURCES];    // Выбросов, где источник вырос
+    uint64_t totals[ATTR_MAX_SOURCES];  // Суммарный прирост по выбросам
+} ProcTable;
+
+/**
+ * @brief Атрибуция выбросов с журналом в заранее выделенном кольце.
+ *
+ * Вся память выделяется в attr_init(): снимки /proc читаются
+ * в постоянный буфер через открытый дескриптор, события пишутся в кольцо с перезаписью
+ * самых старых. Сводка считается при захвате, поэтому перезапись
+ * журнала ее не искажает.
+ */
+typedef struct {
+    int cpu;                        // Ядро, чьи столбцы читаются
+    uint64_t threshold_ns;
+    long long refresh_ns;           // Наибольшее окно, 0 — снимок перед каждой выборкой
+    long long start_ns;
+    long long baseline_ns;          // Момент базового снимка
+    long long next_refresh_ns;
+    char *buf;                      // Буфер чтения /proc
+    ProcTable irq;
+    ProcTable softirq;
+    int msr_fd;                     // /dev/cpu/N/msr или -1
+    uint64_t smi_base;
+    long ctx_vol_base, ctx_invol_base;
+    AttrEvent *ring;
+    size_t capacity;
+    uint64_t events;                // Всего выбросов (включая перезаписанные)
+    // Сколько выбросов сопровождались каждой причиной
+    uint64_t with_irq, with_softirq, with_ctx, with_smi, with_migration, unexplained;
+} Attribution;
+
+/**
+ * @brief Выделяет журнал и открывает источники данных.
+ *
+ * @param attr Структура для инициализации.
+ * @param cpu Ядро, для которого читаются столбцы /proc и MSR.
+ * @param threshold_ns Выборки длиннее порога считаются выбросами.
+ * @param capacity Емкость кольца событий.
+ * @param refresh_ns Наибольшая длина окна; 0 — снимок перед каждой выборкой.
+ * @param start_ns Момент начала прогона (CLOCK_MONOTONIC), нс.
+ * @return 0 при успехе, -1 при нехватке памяти.
+ */
+int attr_init(Attribution *attr, int cpu, uint64_t threshold_ns, size_t capacity,
+              long long refresh_ns, long long start_ns);
+
+// Обновить базовый снимок (вне измеряемого участка)
+void attr_refresh(Attribution *attr, long long now_ns);
+
+/**
+ * @brief Фиксирует выброс: приросты с базового снимка пишутся в журнал,
+ * текущие значения становятся новым базовым снимком.
+ */
+void attr_capture(Attribution *attr, uint64_t index, uint64_t latency_ns, long long now_ns,
+                  int cpu_start, int cpu_end);
+
+/**
+ * @brief Обновляет базовый снимок, если окно стало длиннее refresh_ns.
+ * Вызывается перед замеряемой выборкой, чтобы окно заканчивалось ею.
+ */
+static inline void attr_refresh_if_due(Attribution *attr, long long now_ns) {
+    if (now_ns >= attr->next_refresh_ns) attr_refresh(attr, now_ns);
+}
+
+/**
+ * @brief Печатает сводку по причинам и последние события журнала.
+ */
+void attr_print_summary(const Attribution *attr);
+
+void attr_destroy(Attribution *attr);
+
+#endif // ATTRIBUTION_H
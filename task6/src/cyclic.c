@@ -0,0 +1,99 @@
+#define _GNU_SOURCE
+#include "cyclic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+typedef struct {
+    const CyclicConfig *config;
+    CyclicResult *result;
+    pthread_barrier_t *barrier;
+} CyclicThread;
+
+static long long timespec_to_ns(struct timespec ts) {
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static struct timespec ns_to_timespec(long long ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+static void *cyclic_thread(void *arg) {
+    CyclicThread *ctx = (CyclicThread *)arg;
+    const CyclicConfig *config = ctx->config;
+    CyclicResult *result = ctx->result;
+    long long period = config->period_us * 1000LL;
+
+    // Настройка до барьера: ошибка не должна задерживать остальные потоки
+    result->error = rt_pin_thread(pthread_self(), result->cpu);
+    if (result->error == 0) {
+        result->error = rt_set_fifo(pthread_self(), config->priority);
+    }
+    pthread_barrier_wait(ctx->barrier);
+    if (result->error != 0) return NULL;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long deadline = timespec_to_ns(now) + period;
+
+    for (long i = 0; i < config->loops; i++) {
+        struct timespec next = ns_to_timespec(deadline);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0) {
+            // EINTR: досыпаем до того же абсолютного момента
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long latency = timespec_to_ns(now) - deadline;
+        if (latency < 0) latency = 0;
+        hist_record(&result->hist, (uint64_t)latency);
+
+        // Проснулись после начала следующего периода: пропущенные
+        // дедлайны считаются, а расписание сдвигается, чтобы не
+        // наверстывать их пачкой пробуждений без сна
+        long long skipped = latency / period;
+        result->missed += (uint64_t)skipped;
+        deadline += (skipped + 1) * period;
+    }
+    return NULL;
+}
+
+int cyclic_run(const CyclicConfig *config, CyclicResult *results) {
+    int count = config->cpu_count;
+    pthread_t *threads = malloc(count * sizeof(pthread_t));
+    CyclicThread *ctx = malloc(count * sizeof(CyclicThread));
+    pthread_barrier_t barrier;
+    if (!threads || !ctx || pthread_barrier_init(&barrier, NULL, (unsigned)count) != 0) {
+        perror("cyclic setup failed");
+        free(threads);
+        free(ctx);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i].cpu = config->cpus[i];
+        results[i].error = 0;
+        results[i].missed = 0;
+        hist_init(&results[i].hist);
+        ctx[i].config = config;
+        ctx[i].result = &results[i];
+        ctx[i].barrier = &barrier;
+        if (pthread_create(&threads[i], NULL, cyclic_thread, &ctx[i]) != 0) {
+            // Без всех участников барьер не откроется
+            perror("pthread_create failed");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    free(ctx);
+    free(threads);
+    return 0;
+}
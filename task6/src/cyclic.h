@@ -0,0 +1,49 @@
+#ifndef CYCLIC_H
+#define CYCLIC_H
+
+#include <stdint.h>
+#include "latency_hist.h"
+#include "rt_thread.h"
+
+#define CYCLIC_MIN_PERIOD_US 100
+#define CYCLIC_MAX_PERIOD_US 10000
+
+/**
+ * @brief Параметры измерения задержки периодического пробуждения.
+ */
+typedef struct {
+    int period_us;          // Период пробуждения, мкс
+    long loops;             // Число периодов на каждом ядре
+    int priority;           // Приоритет SCHED_FIFO
+    int cpu_count;          // Число измерительных потоков
+    int cpus[RT_MAX_CPUS];  // Ядро каждого потока
+} CyclicConfig;
+
+/**
+ * @brief Результат одного измерительного потока.
+ *
+ * Задержка — разница между фактическим пробуждением и назначенным
+ * моментом. Дедлайн считается пропущенным, если поток проснулся
+ * позже начала следующего периода.
+ */
+typedef struct {
+    int cpu;
+    int error;              // 0 или код ошибки настройки потока
+    uint64_t missed;        // Пропущенные периоды
+    LatencyHist hist;
+} CyclicResult;
+
+/**
+ * @brief Запускает по одному потоку на каждое ядро из конфигурации.
+ *
+ * Каждый поток закрепляется за своим ядром, переводится в SCHED_FIFO
+ * и спит через clock_nanosleep(TIMER_ABSTIME) до очередного дедлайна.
+ * Потоки стартуют одновременно через барьер.
+ *
+ * @param config Параметры измерения.
+ * @param results Массив из config->cpu_count результатов.
+ * @return 0 при успехе, -1 если не удалось создать потоки.
+ */
+int cyclic_run(const CyclicConfig *config, CyclicResult *results);
+
+#endif // CYCLIC_H
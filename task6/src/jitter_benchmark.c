@@ -6,56 +6,91 @@
 #include <sched.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include "perf_counters.h"
+#include "cyclic.h"
+#include "sweep.h"
+#include "kernels.h"
+#include "stream_stats.h"
+#include "attribution.h"
+#include "stressors.h"
 
 #define NUM_ITERATIONS 1000
-#define MATRIX_SIZE 10
+
+// Параметры режимов --cyclic и --sweep по умолчанию
+#define DEFAULT_PERIOD_US 1000
+#define DEFAULT_DURATION_S 10
+#define DEFAULT_PRIORITY 80
+
+// Интервал снимков статистики по умолчанию, с
+#define DEFAULT_INTERVAL_S 1
 
 // Функция для вычисления разницы времени в наносекундах
 long long timespec_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
 }
 
-// CPU-bound функция: умножение матриц 10x10
-void matrix_multiply() {
-    double A[MATRIX_SIZE][MATRIX_SIZE];
-    double B[MATRIX_SIZE][MATRIX_SIZE];
-    double C[MATRIX_SIZE][MATRIX_SIZE];
-    
-    // Инициализация матриц
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            A[i][j] = (double)rand() / RAND_MAX;
-            B[i][j] = (double)rand() / RAND_MAX;
-            C[i][j] = 0.0;
-        }
+static long long timespec_to_ns(struct timespec ts) {
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Параметры измеряемой нагрузки из командной строки
+typedef struct {
+    KernelId id;
+    size_t working_set;     // 0 — размер по умолчанию для нагрузки
+    KernelIsa isa;
+} KernelSpec;
+
+// Параметры исходного режима
+typedef struct {
+    long long iterations;
+    const char *snapshot_path;      // NULL — без снимков
+    SnapshotFormat snapshot_format;
+    int interval_s;
+    uint64_t threshold_ns;          // 0 — атрибуция выбросов выключена
+    size_t attr_ring;               // Емкость журнала выбросов
+    int attr_window_us;             // Окно атрибуции, 0 — одна выборка
+} IterationOptions;
+
+// Октава интервала гистограммы: значения в [2^k, 2^(k+1))
+static int bucket_octave(int index) {
+    if (index < HIST_SUB_COUNT) return index ? 63 - __builtin_clzll((unsigned long long)index) : 0;
+    return (index - HIST_SUB_COUNT) / HIST_HALF_COUNT + HIST_SUB_BITS;
+}
+
+static void print_octaves(const LatencyHist *hist) {
+    uint64_t octaves[64] = {0};
+    int lo = 63, hi = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        if (!hist->buckets[i]) continue;
+        int k = bucket_octave(i);
+        octaves[k] += hist->buckets[i];
+        if (k < lo) lo = k;
+        if (k > hi) hi = k;
     }
-    
-    // Умножение матриц
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            for (int k = 0; k < MATRIX_SIZE; k++) {
-                C[i][j] += A[i][k] * B[k][j];
-            }
+    for (int k = lo; k <= hi && hist->count; k++) {
+        printf("%12llu-%-12llu ns: %12llu %8.4f%% |", 1ULL << k, (2ULL << k) - 1,
+               (unsigned long long)octaves[k], octaves[k] * 100.0 / hist->count);
+        for (uint64_t j = 0; j < octaves[k] * 50 / hist->count; j++) {
+            printf("#");
         }
+        // Редкие выборки хвоста отмечаются хотя бы одним символом
+        if (octaves[k] && octaves[k] * 50 < hist->count) printf(".");
+        printf("\n");
     }
 }
 
-// Функция для вычисления стандартного отклонения
-double calculate_stddev(long long latencies[], double mean, int count) {
-    double sum_sq_diff = 0.0;
-    for (int i = 0; i < count; i++) {
-        double diff = (double)latencies[i] - mean;
-        sum_sq_diff += diff * diff;
-    }
-    return sqrt(sum_sq_diff / count);
+static void print_kernel(const Kernel *kernel) {
+    printf("Kernel: %s, n=%zu, working set %zu KB, ISA %s\n",
+           kernel_name(kernel->id), kernel->n, kernel->working_set / 1024,
+           kernel_isa_name(kernel->isa));
 }
 
-int main(int argc, char *argv[]) {
-    int target_cpu = -1;
-    
-    // Парсинг аргументов командной строки
-    if (argc > 1) {
-        target_cpu = atoi(argv[1]);
+// Исходный режим: время выполнения нагрузки подряд на одном ядре
+static int run_iteration_benchmark(int target_cpu, const KernelSpec *spec, const IterationOptions *opts) {
+    if (target_cpu != -1) {
         printf("Target CPU specified: %d\n", target_cpu);
     }
     
@@ -87,74 +122,509 @@ int main(int argc, char *argv[]) {
         printf("No CPU affinity set (running on all CPUs)\n");
     }
     
+    // Рабочий набор выделяется после привязки: страницы попадают на узел ядра
+    Kernel kernel;
+    if (kernel_init(&kernel, spec->id, spec->working_set, spec->isa) != 0) {
+        perror("kernel_init failed");
+        return 1;
+    }
+    
     /* --- ИЗМЕРЕНИЕ ПРОИЗВОДИТЕЛЬНОСТИ --- */
-    long long latencies[NUM_ITERATIONS];
-    long long min_latency = -1, max_latency = 0, total_latency = 0;
+    // Память не зависит от числа итераций: все накапливается потоково
+    static StreamStats stats;
+    long long iterations = opts->iterations;
+    
+    // Счетчики: сумма, максимум за итерацию и значения самой медленной итерации.
+    // Отказы страниц читаются только read(), поэтому по ним — лишь сумма за прогон
+    uint64_t before[PERF_CNT_COUNT] = {0}, after[PERF_CNT_COUNT] = {0};
+    uint64_t faults_start[PERF_CNT_COUNT] = {0}, faults_end[PERF_CNT_COUNT] = {0};
+    uint64_t totals[PERF_CNT_COUNT] = {0}, maxes[PERF_CNT_COUNT] = {0}, slowest[PERF_CNT_COUNT] = {0};
+    PerfCounters pc;
+    unsigned opened = perf_counters_open(&pc, PERF_MASK_ALL);
+    const char *hw_path = perf_counters_hw_path(&pc);
+    
+    struct timespec run_start, run_end;
+    clock_gettime(CLOCK_MONOTONIC, &run_start);
+    stats_init(&stats, timespec_to_ns(run_start));
+    if (opts->snapshot_path) {
+        if (stats_open_snapshots(&stats, opts->snapshot_path, opts->snapshot_format,
+                                 opts->interval_s * 1000000000LL) != 0) {
+            perror("snapshot file open failed");
+            return 1;
+        }
+        printf("Writing %s snapshots every %d s to %s\n",
+               opts->snapshot_format == SNAPSHOT_BINARY ? "binary" : "CSV",
+               opts->interval_s, opts->snapshot_path);
+    }
+    
+    // Атрибуция выбросов: журнал выделяется заранее, цикл не выделяет память
+    static Attribution attr;
+    int attribute = opts->threshold_ns > 0;
+    if (attribute) {
+        int cpu = target_cpu != -1 ? target_cpu : sched_getcpu();
+        if (attr_init(&attr, cpu, opts->threshold_ns, opts->attr_ring, opts->attr_window_us * 1000LL,
+                      timespec_to_ns(run_start)) != 0) {
+            perror("attribution setup failed");
+            return 1;
+        }
+        printf("Attributing samples over %llu ns (event log: %zu entries)\n",
+               (unsigned long long)opts->threshold_ns, attr.capacity);
+    }
     
-    printf("\nStarting benchmark (%d iterations)...\n", NUM_ITERATIONS);
+    printf("\nStarting benchmark (%lld iterations)...\n", iterations);
     
-    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+    long long progress_step = iterations >= 10 ? iterations / 10 : 1;
+    long long next_progress = progress_step;
+    perf_counters_read_software(&pc, faults_start);
+    for (long long i = 0; i < iterations; ++i) {
         struct timespec start, end;
+        int cpu_start = -1;
+        if (attribute) {
+            // Снимок до выборки и вне замера: окно атрибуции ограничено ею
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            attr_refresh_if_due(&attr, timespec_to_ns(start));
+            cpu_start = sched_getcpu();
+        }
         
+        perf_counters_read(&pc, before);
         clock_gettime(CLOCK_MONOTONIC, &start);
-        matrix_multiply();
+        kernel_run(&kernel);
         clock_gettime(CLOCK_MONOTONIC, &end);
+        perf_counters_read(&pc, after);
         
-        latencies[i] = timespec_diff_ns(start, end);
-        
-        if (min_latency == -1 || latencies[i] < min_latency) {
-            min_latency = latencies[i];
+        uint64_t latency = (uint64_t)timespec_diff_ns(start, end);
+        int new_max = latency > stats.hist.max;
+        stats_record(&stats, latency, timespec_to_ns(end));
+        if (attribute && latency > opts->threshold_ns) {
+            attr_capture(&attr, (uint64_t)i, latency, timespec_to_ns(end), cpu_start, sched_getcpu());
         }
-        if (latencies[i] > max_latency) {
-            max_latency = latencies[i];
+        for (int c = 0; c < PERF_CNT_COUNT; c++) {
+            uint64_t delta = after[c] - before[c];
+            totals[c] += delta;
+            if (delta > maxes[c]) maxes[c] = delta;
+            if (new_max) slowest[c] = delta;
         }
-        total_latency += latencies[i];
         
         // Прогресс каждые 10%
-        if ((i + 1) % (NUM_ITERATIONS / 10) == 0) {
-            printf("  Progress: %d%%\n", (i + 1) * 100 / NUM_ITERATIONS);
+        if (i + 1 == next_progress) {
+            printf("  Progress: %lld%%\n", (i + 1) * 100 / iterations);
+            next_progress += progress_step;
         }
     }
     
-    double avg_latency = (double)total_latency / NUM_ITERATIONS;
-    long long jitter = max_latency - min_latency;
-    double stddev = calculate_stddev(latencies, avg_latency, NUM_ITERATIONS);
+    perf_counters_read_software(&pc, faults_end);
+    for (int c = 0; c < PERF_CNT_COUNT; c++) {
+        if (PERF_MASK_SOFTWARE & PERF_MASK(c)) totals[c] = faults_end[c] - faults_start[c];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &run_end);
+    stats_finish(&stats, timespec_to_ns(run_end));
+    perf_counters_close(&pc);
+    kernel_destroy(&kernel);
+    
+    const LatencyHist *hist = &stats.hist;
+    double avg_latency = stats.mean;
+    long long jitter = (long long)(hist->max - hist->min);
     
     /* --- ВЫВОД РЕЗУЛЬТАТОВ --- */
     printf("\n=== BENCHMARK RESULTS ===\n");
     printf("Configuration: %s\n", target_cpu != -1 ? "CPU Affinity ON" : "CPU Affinity OFF");
     printf("Scheduler: SCHED_FIFO (priority 50)\n");
-    printf("Iterations: %d\n", NUM_ITERATIONS);
-    printf("Matrix size: %dx%d\n", MATRIX_SIZE, MATRIX_SIZE);
+    printf("Iterations: %lld\n", iterations);
+    print_kernel(&kernel);
     printf("\n--- Latency Statistics ---\n");
-    printf("Min latency:        %12lld ns\n", min_latency);
-    printf("Max latency:        %12lld ns\n", max_latency);
+    printf("Min latency:        %12llu ns\n", (unsigned long long)hist->min);
+    printf("Max latency:        %12llu ns\n", (unsigned long long)hist->max);
     printf("Avg latency:        %12.2f ns\n", avg_latency);
     printf("Jitter (max-min):   %12lld ns\n", jitter);
-    printf("Standard deviation: %12.2f ns\n", stddev);
+    printf("Standard deviation: %12.2f ns\n", stats_stddev(&stats));
     printf("Jitter/Avg ratio:   %12.2f %%\n", (jitter * 100.0) / avg_latency);
+    static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99, 99.999 };
+    for (size_t p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]); p++) {
+        printf("P%-17g %12llu ns\n", percentiles[p],
+               (unsigned long long)hist_percentile(hist, percentiles[p]));
+    }
+    
+    printf("\n--- Perf Counters (%s, per-iteration read: %s) ---\n",
+           opened ? (pc.user_only ? "user space only" : "user + kernel") : "unavailable",
+           hw_path);
+    for (int c = 0; c < PERF_CNT_COUNT; c++) {
+        if (!(opened & PERF_MASK(c))) {
+            printf("%-14s n/a\n", perf_counter_name((PerfCounterId)c));
+            continue;
+        }
+        if (PERF_MASK_SOFTWARE & PERF_MASK(c)) {
+            printf("%-14s total: %12llu  max/iter: %10s  in slowest iter: %10s\n",
+                   perf_counter_name((PerfCounterId)c), (unsigned long long)totals[c], "n/a", "n/a");
+            continue;
+        }
+        printf("%-14s total: %12llu  max/iter: %10llu  in slowest iter: %10llu\n",
+               perf_counter_name((PerfCounterId)c), (unsigned long long)totals[c],
+               (unsigned long long)maxes[c], (unsigned long long)slowest[c]);
+    }
+    
+    // Такты на наносекунду: просадка частоты от AVX видна при сравнении --isa
+    if (opened & PERF_MASK(PERF_CNT_CYCLES)) {
+        printf("Effective frequency: %.2f GHz\n", (double)totals[PERF_CNT_CYCLES] / (double)hist->sum);
+    }
+    
+    // Самые медленные выборки с моментом от начала прогона
+    StatsOutlier top[STATS_TOP_K];
+    int top_count = stats_outliers(&stats, top);
+    printf("\n--- Top %d Slowest Samples ---\n", top_count);
+    for (int i = 0; i < top_count; i++) {
+        printf("%3d. %12llu ns  sample %12llu  at %10.3f s\n", i + 1,
+               (unsigned long long)top[i].value, (unsigned long long)top[i].index,
+               top[i].time_ns / 1e9);
+    }
     
-    // Сохранение гистограммы
+    // Распределение по октавам: хвост виден даже при миллиардах выборок
     printf("\n--- Distribution ---\n");
-    long long bin_size = (max_latency - min_latency) / 10;
-    if (bin_size > 0) {
-        int bins[10] = {0};
-        for (int i = 0; i < NUM_ITERATIONS; i++) {
-            int bin = (latencies[i] - min_latency) / bin_size;
-            if (bin >= 10) bin = 9;
-            bins[bin]++;
+    print_octaves(hist);
+    
+    if (attribute) {
+        attr_print_summary(&attr);
+        attr_destroy(&attr);
+    }
+    
+    return 0;
+}
+
+// Группа ядер в сводке: изолированные против служебных
+typedef struct {
+    int cores;
+    double p99_sum;
+    uint64_t worst_max;
+} CoreGroup;
+
+static void group_add(CoreGroup *group, const LatencyHist *hist) {
+    group->cores++;
+    group->p99_sum += (double)hist_percentile(hist, 99.0);
+    if (hist->max > group->worst_max) group->worst_max = hist->max;
+}
+
+static void print_isolation_summary(const RtIsolation *iso, const CoreGroup *isolated,
+                                    const CoreGroup *housekeeping) {
+    printf("\n--- Isolated vs Housekeeping ---\n");
+    printf("isolated: %s, nohz_full: %s\n",
+           iso->isolated_known ? "read" : "unavailable",
+           iso->nohz_known ? "read" : "unavailable (kernel without NO_HZ_FULL)");
+    const CoreGroup *groups[2] = { isolated, housekeeping };
+    const char *names[2] = { "isolated", "housekeeping" };
+    for (int g = 0; g < 2; g++) {
+        if (groups[g]->cores == 0) {
+            printf("%-13s no cores measured\n", names[g]);
+            continue;
         }
-        
-        for (int i = 0; i < 10; i++) {
-            long long range_start = min_latency + i * bin_size;
-            long long range_end = min_latency + (i + 1) * bin_size;
-            printf("%8lld-%-8lld ns: %4d |", range_start, range_end, bins[i]);
-            for (int j = 0; j < bins[i] * 50 / NUM_ITERATIONS; j++) {
-                printf("#");
+        printf("%-13s cores: %3d  avg P99: %10.0f ns  worst max: %10llu ns\n",
+               names[g], groups[g]->cores, groups[g]->p99_sum / groups[g]->cores,
+               (unsigned long long)groups[g]->worst_max);
+    }
+    if (isolated->cores > 0 && housekeeping->cores > 0) {
+        double iso_p99 = isolated->p99_sum / isolated->cores;
+        double hk_p99 = housekeeping->p99_sum / housekeeping->cores;
+        printf("Isolated cores %s housekeeping cores at P99 (%.2fx)\n",
+               iso_p99 < hk_p99 ? "beat" : "do NOT beat", iso_p99 > 0 ? hk_p99 / iso_p99 : 0.0);
+    }
+}
+
+// Режим cyclictest: задержка пробуждения периодической задачи на каждом ядре
+static int run_cyclic_benchmark(const CyclicConfig *config) {
+    printf("=== CYCLIC WAKE-UP LATENCY ===\n");
+    printf("PID: %d\n", getpid());
+    printf("Period: %d us, loops per CPU: %ld, SCHED_FIFO priority %d, threads: %d\n",
+           config->period_us, config->loops, config->priority, config->cpu_count);
+    
+    // Отказ страниц во время измерения исказил бы задержку
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall failed, continuing without locked memory");
+    }
+    
+    CyclicResult *results = malloc(config->cpu_count * sizeof(CyclicResult));
+    if (!results) {
+        perror("malloc failed");
+        return 1;
+    }
+    if (cyclic_run(config, results) != 0) {
+        free(results);
+        return 1;
+    }
+    
+    RtIsolation iso;
+    rt_isolation_load(&iso);
+    CoreGroup isolated = {0}, housekeeping = {0};
+    
+    printf("\n--- Wake-up Latency per CPU (ns) ---\n");
+    printf("%4s %-12s %10s %10s %10s %10s %10s %10s %10s %8s\n",
+           "CPU", "Role", "Samples", "Min", "Avg", "P50", "P99", "P99.9", "Max", "Missed");
+    int failed = 0;
+    for (int i = 0; i < config->cpu_count; i++) {
+        const CyclicResult *r = &results[i];
+        unsigned flags = r->cpu < RT_MAX_CPUS ? iso.flags[r->cpu] : 0;
+        if (r->error != 0) {
+            printf("%4d setup failed: %s\n", r->cpu, strerror(r->error));
+            failed = 1;
+            continue;
+        }
+        printf("%4d %-12s %10llu %10llu %10.0f %10llu %10llu %10llu %10llu %8llu\n",
+               r->cpu, rt_isolation_label(flags), (unsigned long long)r->hist.count,
+               (unsigned long long)r->hist.min, hist_mean(&r->hist),
+               (unsigned long long)hist_percentile(&r->hist, 50.0),
+               (unsigned long long)hist_percentile(&r->hist, 99.0),
+               (unsigned long long)hist_percentile(&r->hist, 99.9),
+               (unsigned long long)r->hist.max, (unsigned long long)r->missed);
+        group_add(flags ? &isolated : &housekeeping, &r->hist);
+    }
+    if (failed) {
+        printf("SCHED_FIFO and pinning need root (or CAP_SYS_NICE)\n");
+    }
+    print_isolation_summary(&iso, &isolated, &housekeeping);
+    
+    free(results);
+    return failed;
+}
+
+// Режим sweep: нагрузка одновременно на всех ядрах, таблица по ядрам
+static int run_sweep_benchmark(const SweepConfig *config) {
+    printf("=== PER-CORE JITTER SWEEP ===\n");
+    printf("PID: %d\n", getpid());
+    printf("Iterations per CPU: %d, kernel %s, SCHED_FIFO priority %d, threads: %d\n",
+           config->iterations, kernel_name(config->kernel), config->priority, config->cpu_count);
+    
+    SweepResult *results = malloc(config->cpu_count * sizeof(SweepResult));
+    if (!results) {
+        perror("malloc failed");
+        return 1;
+    }
+    if (sweep_run(config, results) != 0) {
+        free(results);
+        return 1;
+    }
+    for (int i = 0; i < config->cpu_count; i++) {
+        if (results[i].error == 0) {
+            printf("Working set per CPU: %zu KB, ISA %s\n",
+                   results[i].working_set / 1024, kernel_isa_name(results[i].isa));
+            break;
+        }
+    }
+    
+    RtIsolation iso;
+    rt_isolation_load(&iso);
+    CoreGroup isolated = {0}, housekeeping = {0};
+    
+    printf("\n--- Latency per CPU (ns) ---\n");
+    printf("%4s %-12s %10s %10s %10s %10s %10s %10s %10s\n",
+           "CPU", "Role", "Min", "Avg", "P50", "P99", "P99.9", "Max", "Jitter");
+    int failed = 0;
+    for (int i = 0; i < config->cpu_count; i++) {
+        const SweepResult *r = &results[i];
+        unsigned flags = r->cpu < RT_MAX_CPUS ? iso.flags[r->cpu] : 0;
+        if (r->error != 0) {
+            printf("%4d setup failed: %s\n", r->cpu, strerror(r->error));
+            failed = 1;
+            continue;
+        }
+        printf("%4d %-12s %10llu %10.0f %10llu %10llu %10llu %10llu %10llu\n",
+               r->cpu, rt_isolation_label(flags),
+               (unsigned long long)r->hist.min, hist_mean(&r->hist),
+               (unsigned long long)hist_percentile(&r->hist, 50.0),
+               (unsigned long long)hist_percentile(&r->hist, 99.0),
+               (unsigned long long)hist_percentile(&r->hist, 99.9),
+               (unsigned long long)r->hist.max,
+               (unsigned long long)(r->hist.max - r->hist.min));
+        group_add(flags ? &isolated : &housekeeping, &r->hist);
+    }
+    if (failed) {
+        printf("SCHED_FIFO and pinning need root (or CAP_SYS_NICE)\n");
+    }
+    print_isolation_summary(&iso, &isolated, &housekeeping);
+    
+    free(results);
+    return failed;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [CPU] [--kernel=NAME] [--ws=SIZE] [--isa=NAME] [--iterations=N]\n", prog);
+    printf("       %*s [--snapshot=FILE] [--snapshot-format=csv|bin] [--interval=SEC]\n", (int)strlen(prog), "");
+    printf("       %*s [--threshold=NS] [--attr-ring=N] [--attr-window=US] [--stress=SPEC...]\n", (int)strlen(prog), "");
+    printf("       %s --cyclic [--period=US] [--duration=SEC] [--cpus=LIST] [--priority=N]\n", prog);
+    printf("       %s --sweep [--iterations=N] [--cpus=LIST] [--priority=N] [--kernel=NAME] [--ws=SIZE] [--isa=NAME]\n", prog);
+    printf("  CPU            pin the iteration benchmark to this CPU\n");
+    printf("  --cyclic       measure periodic wake-up latency (clock_nanosleep, TIMER_ABSTIME)\n");
+    printf("  --sweep        run the kernel on every CPU at once and compare cores\n");
+    printf("  --kernel=NAME  matrix (default), gemm, stream, chase or control\n");
+    printf("  --ws=SIZE      working set: bytes with K/M/G suffix, or l1, l2, llc, dram\n");
+    printf("  --isa=NAME     auto (default), scalar, avx2 or avx512 for gemm\n");
+    printf("  --period=US    wake-up period, %d..%d us (default %d)\n",
+           CYCLIC_MIN_PERIOD_US, CYCLIC_MAX_PERIOD_US, DEFAULT_PERIOD_US);
+    printf("  --duration=SEC measurement time (default %d)\n", DEFAULT_DURATION_S);
+    printf("  --iterations=N kernel iterations (per CPU in --sweep, default %d)\n", NUM_ITERATIONS);
+    printf("  --snapshot=F   write per-interval statistics to F (constant memory for soak runs)\n");
+    printf("  --snapshot-format=csv|bin  snapshot file format (default csv)\n");
+    printf("  --interval=SEC snapshot interval (default %d)\n", DEFAULT_INTERVAL_S);
+    printf("  --threshold=NS attribute samples slower than NS to IRQs, softirqs, context switches,\n");
+    printf("                 SMIs and migrations\n");
+    printf("  --attr-ring=N  outlier event log capacity (default %d)\n", ATTR_DEFAULT_RING);
+    printf("  --attr-window=US  longest attribution window; 0 (default) re-reads /proc before\n");
+    printf("                 every sample so counts cover the outlier sample only\n");
+    printf("  --stress=SPEC  run a background stressor during the measurement (repeatable),\n");
+    printf("                 SPEC = KIND[:cpus=LIST][:intensity=N][:duration=SEC][:size=SIZE][:dir=PATH],\n");
+    printf("                 KIND = cpu, cache, syscall, pagefault, timer or io (see loadgen --help)\n");
+    printf("  --cpus=LIST    CPUs to measure, e.g. 0-3,6 (default: all online CPUs)\n");
+    printf("  --priority=N   SCHED_FIFO priority of measurement threads (default %d)\n", DEFAULT_PRIORITY);
+}
+
+int main(int argc, char *argv[]) {
+    int target_cpu = -1;
+    int cyclic = 0, sweep = 0;
+    int duration_s = DEFAULT_DURATION_S;
+    long long iterations = NUM_ITERATIONS;
+    IterationOptions iter_opts = { 0, NULL, SNAPSHOT_CSV, DEFAULT_INTERVAL_S, 0, ATTR_DEFAULT_RING,
+                                   ATTR_DEFAULT_WINDOW_US };
+    int priority = DEFAULT_PRIORITY;
+    const char *cpu_list = NULL;
+    StressSpec stress_specs[STRESS_MAX];
+    int stress_count = 0;
+    KernelSpec spec = { KERNEL_MATRIX, 0, ISA_AUTO };
+    CyclicConfig config;
+    memset(&config, 0, sizeof(config));
+    config.period_us = DEFAULT_PERIOD_US;
+    
+    // Парсинг аргументов командной строки
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--cyclic") == 0) {
+            cyclic = 1;
+        } else if (strcmp(arg, "--sweep") == 0) {
+            sweep = 1;
+        } else if (strncmp(arg, "--period=", 9) == 0) {
+            config.period_us = atoi(arg + 9);
+        } else if (strncmp(arg, "--duration=", 11) == 0) {
+            duration_s = atoi(arg + 11);
+        } else if (strncmp(arg, "--iterations=", 13) == 0) {
+            iterations = atoll(arg + 13);
+        } else if (strncmp(arg, "--snapshot=", 11) == 0) {
+            iter_opts.snapshot_path = arg + 11;
+        } else if (strncmp(arg, "--snapshot-format=", 18) == 0) {
+            if (stats_parse_format(arg + 18, &iter_opts.snapshot_format) != 0) {
+                printf("Unknown snapshot format: %s\n", arg + 18);
+                return 1;
             }
-            printf("\n");
+        } else if (strncmp(arg, "--interval=", 11) == 0) {
+            iter_opts.interval_s = atoi(arg + 11);
+        } else if (strncmp(arg, "--threshold=", 12) == 0) {
+            iter_opts.threshold_ns = strtoull(arg + 12, NULL, 10);
+        } else if (strncmp(arg, "--attr-ring=", 12) == 0) {
+            iter_opts.attr_ring = (size_t)strtoull(arg + 12, NULL, 10);
+        } else if (strncmp(arg, "--attr-window=", 14) == 0) {
+            iter_opts.attr_window_us = atoi(arg + 14);
+        } else if (strncmp(arg, "--kernel=", 9) == 0) {
+            if (kernel_parse(arg + 9, &spec.id) != 0) {
+                printf("Unknown kernel: %s\n", arg + 9);
+                return 1;
+            }
+        } else if (strncmp(arg, "--ws=", 5) == 0) {
+            spec.working_set = kernel_parse_size(arg + 5);
+            if (spec.working_set == 0) {
+                printf("Bad working set size: %s\n", arg + 5);
+                return 1;
+            }
+        } else if (strncmp(arg, "--isa=", 6) == 0) {
+            if (kernel_parse_isa(arg + 6, &spec.isa) != 0) {
+                printf("Unknown ISA: %s\n", arg + 6);
+                return 1;
+            }
+        } else if (strncmp(arg, "--stress=", 9) == 0) {
+            if (stress_count == STRESS_MAX || stress_parse(argv[i] + 9, &stress_specs[stress_count]) != 0) {
+                printf("Bad stressor spec: %s\n", arg + 9);
+                return 1;
+            }
+            stress_count++;
+        } else if (strncmp(arg, "--cpus=", 7) == 0) {
+            cpu_list = arg + 7;
+        } else if (strncmp(arg, "--priority=", 11) == 0) {
+            priority = atoi(arg + 11);
+        } else if (strcmp(arg, "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            target_cpu = atoi(arg);
+        } else {
+            print_usage(argv[0]);
+            return 1;
         }
     }
     
-    return 0;
-}
\ No newline at end of file
+    if (!cyclic && !sweep) {
+        if (iterations < 1 || iter_opts.interval_s < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        iter_opts.iterations = iterations;
+    }
+    
+    if (cyclic && sweep) {
+        printf("--cyclic and --sweep are mutually exclusive\n");
+        return 1;
+    }
+    if (duration_s < 1 || iterations < 1 || priority < 1 || priority > 99 ||
+        (sweep && iterations > INT_MAX)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (cyclic && (config.period_us < CYCLIC_MIN_PERIOD_US || config.period_us > CYCLIC_MAX_PERIOD_US)) {
+        printf("Period must be within %d..%d us\n", CYCLIC_MIN_PERIOD_US, CYCLIC_MAX_PERIOD_US);
+        return 1;
+    }
+    
+    // Список ядер: явный, одно ядро из позиционного аргумента или все доступные
+    int cpus[RT_MAX_CPUS];
+    int cpu_count;
+    if (cpu_list) {
+        cpu_count = rt_parse_cpulist(cpu_list, cpus, RT_MAX_CPUS);
+    } else if (target_cpu != -1) {
+        cpus[0] = target_cpu;
+        cpu_count = 1;
+    } else {
+        cpu_count = rt_online_cpus(cpus, RT_MAX_CPUS);
+    }
+    if (cpu_count == 0) {
+        printf("Empty CPU list\n");
+        return 1;
+    }
+    
+    // Фоновая нагрузка запускается до измерения и останавливается после него
+    StressGroup stress_group = { 0, { 0 } };
+    if (stress_count > 0) {
+        printf("Starting %d stressor(s):\n", stress_count);
+        for (int i = 0; i < stress_count; i++) {
+            stress_describe(&stress_specs[i]);
+        }
+        if (stress_start(stress_specs, stress_count, &stress_group) != 0) {
+            return 1;
+        }
+    }
+    
+    int rc;
+    if (sweep) {
+        SweepConfig sweep_config;
+        sweep_config.kernel = spec.id;
+        sweep_config.working_set = spec.working_set;
+        sweep_config.isa = spec.isa;
+        sweep_config.iterations = (int)iterations;
+        sweep_config.priority = priority;
+        sweep_config.cpu_count = cpu_count;
+        memcpy(sweep_config.cpus, cpus, cpu_count * sizeof(int));
+        rc = run_sweep_benchmark(&sweep_config);
+    } else if (cyclic) {
+        config.loops = duration_s * 1000000L / config.period_us;
+        config.priority = priority;
+        config.cpu_count = cpu_count;
+        memcpy(config.cpus, cpus, cpu_count * sizeof(int));
+        rc = run_cyclic_benchmark(&config);
+    } else {
+        rc = run_iteration_benchmark(target_cpu, &spec, &iter_opts);
+    }
+    
+    stress_stop(&stress_group);
+    return rc;
+}
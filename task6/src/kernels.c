@@ -0,0 +1,382 @@
+#define _GNU_SOURCE
+#include "kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+#define ALIGNMENT 64
+#define LINE_SIZE 64
+#define MATRIX_SIZE 10
+#define GEMM_BLOCK 64            // Сторона блока: три блока double помещаются в L2
+#define CHASE_STEPS 16384        // Зависимых чтений за итерацию
+#define CONTROL_DT 1e-3          // Шаг регулятора, с
+
+#define DEFAULT_GEMM_SET (3 * 128 * 128 * sizeof(double))
+#define DEFAULT_STREAM_SET (48UL * 1024 * 1024)
+#define DEFAULT_CONTROL_SET (16UL * 1024)
+
+// Кэши по умолчанию, если sysconf их не знает
+#define FALLBACK_L1 (32UL * 1024)
+#define FALLBACK_L2 (1024UL * 1024)
+#define FALLBACK_LLC (32UL * 1024 * 1024)
+
+// Один канал регулятора занимает кэш-линию
+typedef struct {
+    double setpoint;
+    double y;
+    double integral;
+    double prev_error;
+    double kp, ki, kd;
+    double tau;
+} Channel;
+
+static const char *kernel_names[KERNEL_COUNT] = { "matrix", "gemm", "stream", "chase", "control" };
+static const char *isa_names[] = { "scalar", "avx2", "avx512" };
+
+/* --- Строка GEMM: c[0..len) += a * b[0..len) для каждого набора инструкций --- */
+
+typedef void (*AxpyFunc)(double *c, const double *b, double a, size_t len);
+
+static void axpy_scalar(double *c, const double *b, double a, size_t len) {
+    for (size_t j = 0; j < len; j++) {
+        c[j] += a * b[j];
+    }
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("avx2,fma")))
+static void axpy_avx2(double *c, const double *b, double a, size_t len) {
+    __m256d va = _mm256_set1_pd(a);
+    size_t j = 0;
+    for (; j + 4 <= len; j += 4) {
+        __m256d vc = _mm256_loadu_pd(c + j);
+        vc = _mm256_fmadd_pd(va, _mm256_loadu_pd(b + j), vc);
+        _mm256_storeu_pd(c + j, vc);
+    }
+    for (; j < len; j++) {
+        c[j] += a * b[j];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void axpy_avx512(double *c, const double *b, double a, size_t len) {
+    __m512d va = _mm512_set1_pd(a);
+    size_t j = 0;
+    for (; j + 8 <= len; j += 8) {
+        __m512d vc = _mm512_loadu_pd(c + j);
+        vc = _mm512_fmadd_pd(va, _mm512_loadu_pd(b + j), vc);
+        _mm512_storeu_pd(c + j, vc);
+    }
+    for (; j < len; j++) {
+        c[j] += a * b[j];
+    }
+}
+#endif
+
+static AxpyFunc axpy_for(KernelIsa isa) {
+#ifdef KERNELS_X86
+    if (isa == ISA_AVX512) return axpy_avx512;
+    if (isa == ISA_AVX2) return axpy_avx2;
+#endif
+    (void)isa;
+    return axpy_scalar;
+}
+
+KernelIsa kernel_detect_isa(void) {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return ISA_AVX2;
+#endif
+    return ISA_SCALAR;
+}
+
+/* --- Нагрузки --- */
+
+// Исходная нагрузка: матрицы 10x10 на стеке, заполняемые rand_r()
+static void run_matrix(Kernel *kernel) {
+    double A[MATRIX_SIZE][MATRIX_SIZE];
+    double B[MATRIX_SIZE][MATRIX_SIZE];
+    double C[MATRIX_SIZE][MATRIX_SIZE];
+
+    for (int i = 0; i < MATRIX_SIZE; i++) {
+        for (int j = 0; j < MATRIX_SIZE; j++) {
+            A[i][j] = (double)rand_r(&kernel->seed) / RAND_MAX;
+            B[i][j] = (double)rand_r(&kernel->seed) / RAND_MAX;
+            C[i][j] = 0.0;
+        }
+    }
+
+    for (int i = 0; i < MATRIX_SIZE; i++) {
+        for (int j = 0; j < MATRIX_SIZE; j++) {
+            for (int k = 0; k < MATRIX_SIZE; k++) {
+                C[i][j] += A[i][k] * B[k][j];
+            }
+        }
+    }
+    kernel->sink += C[MATRIX_SIZE - 1][MATRIX_SIZE - 1];
+}
+
+// Блочное C = A * B: порядок i-k-j, внутренний цикл — векторная строка
+static void run_gemm(Kernel *kernel) {
+    size_t n = kernel->n;
+    const double *A = kernel->a, *B = kernel->b;
+    double *C = kernel->c;
+    AxpyFunc axpy = axpy_for(kernel->isa);
+
+    memset(C, 0, n * n * sizeof(double));
+    for (size_t ii = 0; ii < n; ii += GEMM_BLOCK) {
+        size_t i_end = ii + GEMM_BLOCK < n ? ii + GEMM_BLOCK : n;
+        for (size_t kk = 0; kk < n; kk += GEMM_BLOCK) {
+            size_t k_end = kk + GEMM_BLOCK < n ? kk + GEMM_BLOCK : n;
+            for (size_t jj = 0; jj < n; jj += GEMM_BLOCK) {
+                size_t len = jj + GEMM_BLOCK < n ? GEMM_BLOCK : n - jj;
+                for (size_t i = ii; i < i_end; i++) {
+                    for (size_t k = kk; k < k_end; k++) {
+                        axpy(&C[i * n + jj], &B[k * n + jj], A[i * n + k], len);
+                    }
+                }
+            }
+        }
+    }
+    kernel->sink += C[n * n - 1];
+}
+
+// STREAM triad: упирается в пропускную способность памяти
+static void run_stream(Kernel *kernel) {
+    size_t n = kernel->n;
+    double *a = kernel->a;
+    const double *b = kernel->b, *c = kernel->c;
+    const double scalar = 3.0;
+    for (size_t i = 0; i < n; i++) {
+        a[i] = b[i] + scalar * c[i];
+    }
+    kernel->sink += a[n / 2];
+}
+
+// Каждое чтение зависит от предыдущего: время итерации — задержка уровня памяти
+static void run_chase(Kernel *kernel) {
+    char *p = kernel->cursor;
+    for (int i = 0; i < CHASE_STEPS; i++) {
+        p = *(char **)p;
+    }
+    kernel->cursor = p;
+}
+
+// Один период управления: ПИД с ограничением интеграла и нелинейный объект
+static void run_control(Kernel *kernel) {
+    Channel *ch = (Channel *)kernel->channels;
+    double sum = 0.0;
+    for (size_t i = 0; i < kernel->n; i++) {
+        Channel *c = &ch[i];
+        double error = c->setpoint - c->y;
+        c->integral = fmin(fmax(c->integral + error * CONTROL_DT, -10.0), 10.0);
+        double derivative = (error - c->prev_error) / CONTROL_DT;
+        double u = c->kp * error + c->ki * c->integral + c->kd * derivative;
+        u = fmin(fmax(u, -100.0), 100.0);
+        c->prev_error = error;
+        c->y += CONTROL_DT * (u - c->y - 0.1 * sin(c->y)) / c->tau;
+        c->setpoint = cos(c->setpoint + CONTROL_DT);
+        sum += c->y;
+    }
+    kernel->sink += sum;
+}
+
+/* --- Инициализация --- */
+
+static void *alloc_aligned(size_t size) {
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, ALIGNMENT, size) != 0) return NULL;
+    return ptr;
+}
+
+// Замкнуть кэш-линии в один случайный цикл (алгоритм Саттоло)
+static int build_chain(Kernel *kernel) {
+    size_t lines = kernel->n;
+    uint32_t *perm = malloc(lines * sizeof(uint32_t));
+    if (!perm) return -1;
+    for (size_t i = 0; i < lines; i++) perm[i] = (uint32_t)i;
+    unsigned seed = 2463534242u;
+    for (size_t i = lines - 1; i > 0; i--) {
+        size_t j = (size_t)rand_r(&seed) % i;
+        uint32_t tmp = perm[i]; perm[i] = perm[j]; perm[j] = tmp;
+    }
+    for (size_t i = 0; i < lines; i++) {
+        *(char **)(kernel->lines + i * LINE_SIZE) = kernel->lines + (size_t)perm[i] * LINE_SIZE;
+    }
+    free(perm);
+    kernel->cursor = kernel->lines;
+    return 0;
+}
+
+int kernel_init(Kernel *kernel, KernelId id, size_t working_set, KernelIsa isa) {
+    memset(kernel, 0, sizeof(*kernel));
+    kernel->id = id;
+    kernel->seed = 1;
+    // Векторный путь с диспетчеризацией есть только у GEMM
+    KernelIsa best = id == KERNEL_GEMM ? kernel_detect_isa() : ISA_SCALAR;
+    kernel->isa = (isa == ISA_AUTO || isa > best) ? best : isa;
+
+    switch (id) {
+    case KERNEL_MATRIX:
+        kernel->n = MATRIX_SIZE;
+        kernel->working_set = 3 * MATRIX_SIZE * MATRIX_SIZE * sizeof(double);
+        return 0;
+    case KERNEL_GEMM: {
+        if (working_set == 0) working_set = DEFAULT_GEMM_SET;
+        size_t n = (size_t)sqrt((double)working_set / (3 * sizeof(double)));
+        n = n < 8 ? 8 : n & ~(size_t)7;
+        kernel->n = n;
+        kernel->working_set = 3 * n * n * sizeof(double);
+        kernel->a = alloc_aligned(n * n * sizeof(double));
+        kernel->b = alloc_aligned(n * n * sizeof(double));
+        kernel->c = alloc_aligned(n * n * sizeof(double));
+        if (!kernel->a || !kernel->b || !kernel->c) break;
+        for (size_t i = 0; i < n * n; i++) {
+            kernel->a[i] = (double)rand_r(&kernel->seed) / RAND_MAX;
+            kernel->b[i] = (double)rand_r(&kernel->seed) / RAND_MAX;
+            kernel->c[i] = 0.0;
+        }
+        return 0;
+    }
+    case KERNEL_STREAM: {
+        if (working_set == 0) working_set = DEFAULT_STREAM_SET;
+        size_t n = working_set / (3 * sizeof(double));
+        if (n < 1024) n = 1024;
+        kernel->n = n;
+        kernel->working_set = 3 * n * sizeof(double);
+        kernel->a = alloc_aligned(n * sizeof(double));
+        kernel->b = alloc_aligned(n * sizeof(double));
+        kernel->c = alloc_aligned(n * sizeof(double));
+        if (!kernel->a || !kernel->b || !kernel->c) break;
+        for (size_t i = 0; i < n; i++) {
+            kernel->a[i] = 0.0;
+            kernel->b[i] = 1.0;
+            kernel->c[i] = 2.0;
+        }
+        return 0;
+    }
+    case KERNEL_CHASE: {
+        if (working_set == 0) working_set = kernel_parse_size("l2");
+        size_t lines = working_set / LINE_SIZE;
+        if (lines < 2) lines = 2;
+        kernel->n = lines;
+        kernel->working_set = lines * LINE_SIZE;
+        kernel->lines = alloc_aligned(kernel->working_set);
+        if (!kernel->lines || build_chain(kernel) != 0) break;
+        return 0;
+    }
+    case KERNEL_CONTROL: {
+        if (working_set == 0) working_set = DEFAULT_CONTROL_SET;
+        size_t n = working_set / sizeof(Channel);
+        if (n < 1) n = 1;
+        kernel->n = n;
+        kernel->working_set = n * sizeof(Channel);
+        Channel *ch = alloc_aligned(kernel->working_set);
+        kernel->channels = ch;
+        if (!ch) break;
+        for (size_t i = 0; i < n; i++) {
+            ch[i] = (Channel){ .setpoint = 1.0, .y = 0.0, .integral = 0.0, .prev_error = 0.0,
+                               .kp = 2.0 + (double)(i % 7) * 0.1, .ki = 0.5, .kd = 0.01,
+                               .tau = 0.05 + (double)(i % 5) * 0.01 };
+        }
+        return 0;
+    }
+    default:
+        return -1;
+    }
+
+    kernel_destroy(kernel);
+    return -1;
+}
+
+void kernel_run(Kernel *kernel) {
+    switch (kernel->id) {
+    case KERNEL_MATRIX:  run_matrix(kernel); break;
+    case KERNEL_GEMM:    run_gemm(kernel); break;
+    case KERNEL_STREAM:  run_stream(kernel); break;
+    case KERNEL_CHASE:   run_chase(kernel); break;
+    case KERNEL_CONTROL: run_control(kernel); break;
+    default: break;
+    }
+    // Курсор и sink должны остаться видимыми: иначе -O2 выбросит обход
+    __asm__ __volatile__("" : : "r"(kernel->cursor), "m"(kernel->sink) : "memory");
+}
+
+void kernel_destroy(Kernel *kernel) {
+    free(kernel->a);
+    free(kernel->b);
+    free(kernel->c);
+    free(kernel->lines);
+    free(kernel->channels);
+    kernel->a = kernel->b = kernel->c = NULL;
+    kernel->lines = kernel->cursor = NULL;
+    kernel->channels = NULL;
+}
+
+/* --- Имена и размеры --- */
+
+int kernel_parse(const char *name, KernelId *id) {
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if (strcmp(name, kernel_names[i]) == 0) {
+            *id = (KernelId)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *kernel_name(KernelId id) {
+    return (id >= 0 && id < KERNEL_COUNT) ? kernel_names[id] : "unknown";
+}
+
+int kernel_parse_isa(const char *name, KernelIsa *isa) {
+    if (strcmp(name, "auto") == 0) {
+        *isa = ISA_AUTO;
+        return 0;
+    }
+    for (int i = ISA_SCALAR; i <= ISA_AVX512; i++) {
+        if (strcmp(name, isa_names[i]) == 0) {
+            *isa = (KernelIsa)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *kernel_isa_name(KernelIsa isa) {
+    return (isa >= ISA_SCALAR && isa <= ISA_AVX512) ? isa_names[isa] : "auto";
+}
+
+static size_t cache_size(int name, size_t fallback) {
+    long size = sysconf(name);
+    return size > 0 ? (size_t)size : fallback;
+}
+
+size_t kernel_parse_size(const char *text) {
+    if (strcmp(text, "l1") == 0) return cache_size(_SC_LEVEL1_DCACHE_SIZE, FALLBACK_L1) / 2;
+    if (strcmp(text, "l2") == 0) return cache_size(_SC_LEVEL2_CACHE_SIZE, FALLBACK_L2) / 2;
+
+    size_t llc = cache_size(_SC_LEVEL3_CACHE_SIZE, 0);
+    if (llc == 0) llc = cache_size(_SC_LEVEL2_CACHE_SIZE, FALLBACK_LLC);
+    if (strcmp(text, "llc") == 0) return llc / 2;
+    if (strcmp(text, "dram") == 0) return llc * 4;
+
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) return 0;
+    switch (*end) {
+    case 'k': case 'K': value <<= 10; end++; break;
+    case 'm': case 'M': value <<= 20; end++; break;
+    case 'g': case 'G': value <<= 30; end++; break;
+    default: break;
+    }
+    return *end == '\0' ? (size_t)value : 0;
+}
@@ -0,0 +1,106 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Измеряемые нагрузки.
+ */
+typedef enum {
+    KERNEL_MATRIX,   // Исходное умножение 10x10 со случайными данными
+    KERNEL_GEMM,     // Блочное умножение матриц n x n (SIMD)
+    KERNEL_STREAM,   // Triad a = b + s * c по рабочему набору
+    KERNEL_CHASE,    // Зависимые чтения по случайному циклу кэш-линий
+    KERNEL_CONTROL,  // Банк ПИД-регуляторов с моделью объекта (FP)
+    KERNEL_COUNT
+} KernelId;
+
+/**
+ * @brief Набор инструкций для векторных ядер.
+ */
+typedef enum {
+    ISA_AUTO = -1,   // Лучший из поддерживаемых процессором
+    ISA_SCALAR,
+    ISA_AVX2,
+    ISA_AVX512
+} KernelIsa;
+
+/**
+ * @brief Состояние нагрузки: буферы рабочего набора и параметры.
+ *
+ * Каждый поток владеет своим экземпляром, поэтому kernel_run()
+ * не синхронизируется и не выделяет память.
+ */
+typedef struct {
+    KernelId id;
+    KernelIsa isa;          // Фактически используемый набор инструкций
+    size_t working_set;     // Байт, реально занятых буферами
+    size_t n;               // Размер задачи (сторона матрицы, элементы, линии, каналы)
+    double *a, *b, *c;      // Матрицы GEMM / массивы stream
+    char *lines;            // Кэш-линии для pointer chase
+    char *cursor;           // Текущая позиция обхода
+    void *channels;         // Каналы control-law
+    unsigned seed;          // Состояние rand_r для KERNEL_MATRIX
+    double sink;            // Результат, не дающий компилятору выбросить работу
+} Kernel;
+
+/**
+ * @brief Выделяет и заполняет рабочий набор нагрузки.
+ *
+ * Вызывать из потока, который будет выполнять нагрузку: страницы
+ * размещаются первым касанием на его узле NUMA.
+ *
+ * @param kernel Структура для инициализации.
+ * @param id Вид нагрузки.
+ * @param working_set Желаемый размер рабочего набора в байтах
+ *                    (0 — размер по умолчанию для нагрузки).
+ * @param isa Набор инструкций; неподдерживаемый понижается до доступного.
+ * @return 0 при успехе, -1 при нехватке памяти.
+ */
+int kernel_init(Kernel *kernel, KernelId id, size_t working_set, KernelIsa isa);
+
+/**
+ * @brief Выполняет одну итерацию нагрузки.
+ */
+void kernel_run(Kernel *kernel);
+
+/**
+ * @brief Освобождает буферы нагрузки.
+ */
+void kernel_destroy(Kernel *kernel);
+
+/**
+ * @brief Находит нагрузку по имени ("matrix", "gemm", "stream", "chase", "control").
+ *
+ * @return 0 при успехе, -1 для неизвестного имени.
+ */
+int kernel_parse(const char *name, KernelId *id);
+
+const char *kernel_name(KernelId id);
+
+/**
+ * @brief Находит набор инструкций по имени ("auto", "scalar", "avx2", "avx512").
+ *
+ * @return 0 при успехе, -1 для неизвестного имени.
+ */
+int kernel_parse_isa(const char *name, KernelIsa *isa);
+
+const char *kernel_isa_name(KernelIsa isa);
+
+/**
+ * @brief Лучший набор инструкций, поддерживаемый процессором.
+ */
+KernelIsa kernel_detect_isa(void);
+
+/**
+ * @brief Разбирает размер рабочего набора: число с суффиксом K/M/G
+ * или уровень кэша "l1", "l2", "llc", "dram".
+ *
+ * Уровень кэша переводится в половину его размера (набор помещается
+ * в этот уровень, но не в предыдущий); "dram" — четыре размера LLC.
+ *
+ * @return Размер в байтах или 0 при ошибке.
+ */
+size_t kernel_parse_size(const char *text);
+
+#endif // KERNELS_H
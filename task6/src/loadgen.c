@@ -0,0 +1,71 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "stressors.h"
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    interrupted = 1;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s SPEC [SPEC...]\n", prog);
+    printf("  SPEC = KIND[:cpus=LIST][:intensity=1..100][:duration=SEC][:size=SIZE][:dir=PATH]\n");
+    printf("  KIND = cpu | cache | syscall | pagefault | timer | io\n");
+    printf("  intensity is the busy share of every %lld ms period;\n", STRESS_PERIOD_NS / 1000000);
+    printf("  for timer it sets the wake-up rate (100 = every 10 us, 1 = every 1 ms)\n");
+    printf("Example: %s cpu:cpus=1:intensity=50 cache:cpus=2:size=64M io:duration=30\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc - 1 > STRESS_MAX || strcmp(argv[1], "--help") == 0) {
+        print_usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    StressSpec specs[STRESS_MAX];
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (stress_parse(argv[i], &specs[count]) != 0) {
+            printf("Bad stressor spec: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+        count++;
+    }
+
+    printf("=== LOAD GENERATOR ===\n");
+    printf("PID: %d\n", getpid());
+    for (int i = 0; i < count; i++) {
+        stress_describe(&specs[i]);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    StressGroup group;
+    if (stress_start(specs, count, &group) != 0) {
+        return 1;
+    }
+    printf("Running, press Ctrl+C to stop\n");
+
+    // Ждать, пока стрессоры не завершатся сами или не придет сигнал
+    while (!interrupted) {
+        if (wait(NULL) < 0 && errno == ECHILD) break;
+    }
+    if (interrupted) {
+        stress_stop(&group);
+    }
+    printf("Load generator stopped\n");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#define _GNU_SOURCE
+#include "rt_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+int rt_parse_cpulist(const char *list, int *cpus, int max) {
+    int count = 0;
+    const char *p = list;
+    while (*p && count < max) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1) break;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && count < max; cpu++) {
+            cpus[count++] = (int)cpu;
+        }
+        if (*p != ',') break;
+        p++;
+    }
+    return count;
+}
+
+int rt_online_cpus(int *cpus, int max) {
+    // Список online, а не маска процесса: при isolcpus= унаследованная
+    // маска не содержит изолированных ядер, а их и нужно сравнивать
+    FILE *f = fopen("/sys/devices/system/cpu/online", "r");
+    if (f) {
+        char line[1024];
+        int count = fgets(line, sizeof(line), f) ? rt_parse_cpulist(line, cpus, max) : 0;
+        fclose(f);
+        if (count > 0) return count;
+    }
+
+    cpu_set_t allowed;
+    int count = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        cpus[0] = 0;
+        return 1;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE && count < max; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) cpus[count++] = cpu;
+    }
+    return count;
+}
+
+int rt_pin_thread(pthread_t thread, int cpu) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return pthread_setaffinity_np(thread, sizeof(mask), &mask);
+}
+
+int rt_set_fifo(pthread_t thread, int priority) {
+    struct sched_param sp;
+    sp.sched_priority = priority;
+    return pthread_setschedparam(thread, SCHED_FIFO, &sp);
+}
+
+// Выставить признак flag ядрам из файла со списком; 0 — файла нет
+static int load_cpulist_flag(const char *path, unsigned flag, unsigned *flags) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    char line[1024];
+    if (fgets(line, sizeof(line), f)) {
+        int cpus[RT_MAX_CPUS];
+        int count = rt_parse_cpulist(line, cpus, RT_MAX_CPUS);
+        for (int i = 0; i < count; i++) {
+            if (cpus[i] >= 0 && cpus[i] < RT_MAX_CPUS) flags[cpus[i]] |= flag;
+        }
+    }
+    fclose(f);
+    return 1;
+}
+
+void rt_isolation_load(RtIsolation *iso) {
+    memset(iso, 0, sizeof(*iso));
+    iso->isolated_known = load_cpulist_flag("/sys/devices/system/cpu/isolated",
+                                            RT_CPU_ISOLATED, iso->flags);
+    iso->nohz_known = load_cpulist_flag("/sys/devices/system/cpu/nohz_full",
+                                        RT_CPU_NOHZ_FULL, iso->flags);
+}
+
+const char *rt_isolation_label(unsigned flags) {
+    if ((flags & RT_CPU_ISOLATED) && (flags & RT_CPU_NOHZ_FULL)) return "isol+nohz";
+    if (flags & RT_CPU_ISOLATED) return "isolated";
+    if (flags & RT_CPU_NOHZ_FULL) return "nohz_full";
+    return "housekeeping";
+}
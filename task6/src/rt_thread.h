@@ -0,0 +1,71 @@
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+#include <pthread.h>
+
+#define RT_MAX_CPUS 256
+
+// Признаки ядра из /sys/devices/system/cpu
+#define RT_CPU_ISOLATED  (1u << 0) // isolcpus / cpuset isolated
+#define RT_CPU_NOHZ_FULL (1u << 1) // тик отключается при одной задаче
+
+/**
+ * @brief Изоляция ядер по данным ядра ОС.
+ */
+typedef struct {
+    int isolated_known;           // Файл isolated прочитан
+    int nohz_known;               // Файл nohz_full прочитан
+    unsigned flags[RT_MAX_CPUS];  // Комбинация RT_CPU_* для каждого ядра
+} RtIsolation;
+
+/**
+ * @brief Разбирает список ядер в формате cpulist ("0-3,8,10-11").
+ *
+ * @param list Строка со списком (пустая строка — пустой список).
+ * @param cpus Массив для номеров ядер.
+ * @param max Емкость массива.
+ * @return Число ядер в списке.
+ */
+int rt_parse_cpulist(const char *list, int *cpus, int max);
+
+/**
+ * @brief Возвращает список включенных ядер (/sys/devices/system/cpu/online),
+ * включая изолированные; без sysfs — ядра из маски процесса.
+ *
+ * @param cpus Массив для номеров ядер.
+ * @param max Емкость массива.
+ * @return Число ядер.
+ */
+int rt_online_cpus(int *cpus, int max);
+
+/**
+ * @brief Закрепляет поток за одним ядром.
+ *
+ * @return 0 при успехе, иначе код ошибки pthread.
+ */
+int rt_pin_thread(pthread_t thread, int cpu);
+
+/**
+ * @brief Переводит поток в SCHED_FIFO с заданным приоритетом.
+ *
+ * @return 0 при успехе, иначе код ошибки pthread.
+ */
+int rt_set_fifo(pthread_t thread, int priority);
+
+/**
+ * @brief Читает /sys/devices/system/cpu/isolated и nohz_full.
+ *
+ * Отсутствующий файл (ядро собрано без NO_HZ_FULL) не считается
+ * ошибкой: соответствующий признак просто не выставляется.
+ *
+ * @param iso Структура для результата.
+ */
+void rt_isolation_load(RtIsolation *iso);
+
+/**
+ * @brief Возвращает короткую метку ядра: "isolated", "nohz_full",
+ * "isol+nohz" или "housekeeping".
+ */
+const char *rt_isolation_label(unsigned flags);
+
+#endif // RT_THREAD_H
@@ -0,0 +1,133 @@
+#include "stream_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void stats_init(StreamStats *stats, long long start_ns) {
+    memset(stats, 0, sizeof(*stats));
+    hist_init(&stats->hist);
+    hist_init(&stats->interval);
+    stats->start_ns = start_ns;
+}
+
+int stats_open_snapshots(StreamStats *stats, const char *path, SnapshotFormat format,
+                         long long interval_ns) {
+    stats->snapshot = fopen(path, format == SNAPSHOT_BINARY ? "wb" : "w");
+    if (!stats->snapshot) return -1;
+    stats->format = format;
+    stats->interval_ns = interval_ns;
+    stats->next_snapshot_ns = stats->start_ns + interval_ns;
+
+    if (format == SNAPSHOT_BINARY) {
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = 1;
+        header.record_size = sizeof(SnapshotRecord);
+        header.interval_ns = interval_ns;
+        fwrite(&header, sizeof(header), 1, stats->snapshot);
+    } else {
+        fprintf(stats->snapshot, "interval,end_ns,count,min_ns,max_ns,mean_ns,p50_ns,p99_ns,p999_ns\n");
+    }
+    return 0;
+}
+
+void stats_flush_interval(StreamStats *stats, long long now_ns) {
+    const LatencyHist *h = &stats->interval;
+    SnapshotRecord rec;
+    rec.interval = stats->snapshots++;
+    rec.end_ns = now_ns - stats->start_ns;
+    rec.count = h->count;
+    rec.min = h->count ? h->min : 0;
+    rec.max = h->max;
+    rec.mean = hist_mean(h);
+    rec.p50 = hist_percentile(h, 50.0);
+    rec.p99 = hist_percentile(h, 99.0);
+    rec.p999 = hist_percentile(h, 99.9);
+
+    if (stats->format == SNAPSHOT_BINARY) {
+        fwrite(&rec, sizeof(rec), 1, stats->snapshot);
+    } else {
+        fprintf(stats->snapshot, "%llu,%lld,%llu,%llu,%llu,%.1f,%llu,%llu,%llu\n",
+                (unsigned long long)rec.interval, (long long)rec.end_ns,
+                (unsigned long long)rec.count, (unsigned long long)rec.min,
+                (unsigned long long)rec.max, rec.mean, (unsigned long long)rec.p50,
+                (unsigned long long)rec.p99, (unsigned long long)rec.p999);
+    }
+
+    hist_init(&stats->interval);
+    // Пропущенные интервалы (долгая выборка) не порождают пустых снимков
+    while (stats->next_snapshot_ns <= now_ns) {
+        stats->next_snapshot_ns += stats->interval_ns;
+    }
+}
+
+static void swap_outliers(StatsOutlier *a, StatsOutlier *b) {
+    StatsOutlier tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+void stats_push_outlier(StreamStats *stats, uint64_t value, long long now_ns) {
+    StatsOutlier item = { value, stats->count - 1, now_ns - stats->start_ns };
+    StatsOutlier *heap = stats->top;
+
+    if (stats->top_count < STATS_TOP_K) {
+        // Просеивание вверх
+        int i = stats->top_count++;
+        heap[i] = item;
+        while (i > 0 && heap[(i - 1) / 2].value > heap[i].value) {
+            swap_outliers(&heap[(i - 1) / 2], &heap[i]);
+            i = (i - 1) / 2;
+        }
+        return;
+    }
+
+    // Замена минимума и просеивание вниз
+    heap[0] = item;
+    int i = 0;
+    for (;;) {
+        int left = 2 * i + 1, right = left + 1, smallest = i;
+        if (left < STATS_TOP_K && heap[left].value < heap[smallest].value) smallest = left;
+        if (right < STATS_TOP_K && heap[right].value < heap[smallest].value) smallest = right;
+        if (smallest == i) break;
+        swap_outliers(&heap[i], &heap[smallest]);
+        i = smallest;
+    }
+}
+
+double stats_stddev(const StreamStats *stats) {
+    return stats->count ? sqrt(stats->m2 / (double)stats->count) : 0.0;
+}
+
+static int compare_desc(const void *a, const void *b) {
+    uint64_t va = ((const StatsOutlier *)a)->value;
+    uint64_t vb = ((const StatsOutlier *)b)->value;
+    return (va < vb) - (va > vb);
+}
+
+int stats_outliers(const StreamStats *stats, StatsOutlier *out) {
+    memcpy(out, stats->top, stats->top_count * sizeof(StatsOutlier));
+    qsort(out, stats->top_count, sizeof(StatsOutlier), compare_desc);
+    return stats->top_count;
+}
+
+void stats_finish(StreamStats *stats, long long now_ns) {
+    if (!stats->snapshot) return;
+    if (stats->interval.count > 0) {
+        stats_flush_interval(stats, now_ns);
+    }
+    fclose(stats->snapshot);
+    stats->snapshot = NULL;
+}
+
+int stats_parse_format(const char *name, SnapshotFormat *format) {
+    if (strcmp(name, "csv") == 0) {
+        *format = SNAPSHOT_CSV;
+    } else if (strcmp(name, "bin") == 0) {
+        *format = SNAPSHOT_BINARY;
+    } else {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "latency_hist.h"
+
+// Число самых медленных выборок, хранимых точно
+#define STATS_TOP_K 16
+
+// Заголовок бинарного файла снимков
+#define SNAPSHOT_MAGIC "JITSNAP1"
+
+/**
+ * @brief Формат файла интервальных снимков.
+ */
+typedef enum {
+    SNAPSHOT_NONE,
+    SNAPSHOT_CSV,
+    SNAPSHOT_BINARY
+} SnapshotFormat;
+
+/**
+ * @brief Одна выборка из top-K.
+ */
+typedef struct {
+    uint64_t value;         // Задержка, нс
+    uint64_t index;         // Номер выборки от начала прогона
+    long long time_ns;      // Время от начала прогона, нс
+} StatsOutlier;
+
+/**
+ * @brief Запись бинарного файла снимков (после заголовка SnapshotHeader).
+ */
+typedef struct {
+    uint64_t interval;      // Номер интервала
+    int64_t end_ns;         // Конец интервала от начала прогона
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double mean;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+} SnapshotRecord;
+
+typedef struct {
+    char magic[8];          // SNAPSHOT_MAGIC без завершающего нуля
+    uint32_t version;
+    uint32_t record_size;   // sizeof(SnapshotRecord)
+    int64_t interval_ns;
+} SnapshotHeader;
+
+/**
+ * @brief Потоковая статистика задержек с памятью O(1).
+ *
+ * Среднее и дисперсия считаются по Уэлфорду, распределение хранится
+ * в лог-линейной гистограмме, самые медленные выборки — в куче
+ * фиксированного размера. Отдельная гистограмма текущего интервала
+ * сбрасывается после каждого снимка, поэтому суточный прогон занимает
+ * столько же памяти, сколько секундный.
+ */
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;                          // Сумма квадратов отклонений (Уэлфорд)
+    LatencyHist hist;                   // Весь прогон
+    LatencyHist interval;               // Текущий интервал
+    StatsOutlier top[STATS_TOP_K];      // Мин-куча по value
+    int top_count;
+    FILE *snapshot;
+    SnapshotFormat format;
+    long long start_ns;
+    long long interval_ns;
+    long long next_snapshot_ns;
+    uint64_t snapshots;
+} StreamStats;
+
+/**
+ * @brief Инициализирует статистику.
+ *
+ * @param stats Структура для инициализации.
+ * @param start_ns Момент начала прогона (CLOCK_MONOTONIC), нс.
+ */
+void stats_init(StreamStats *stats, long long start_ns);
+
+/**
+ * @brief Включает запись снимков каждые interval_ns наносекунд.
+ *
+ * @param stats Статистика.
+ * @param path Путь к файлу (перезаписывается).
+ * @param format SNAPSHOT_CSV или SNAPSHOT_BINARY.
+ * @param interval_ns Длина интервала.
+ * @return 0 при успехе, -1 если файл не открылся.
+ */
+int stats_open_snapshots(StreamStats *stats, const char *path, SnapshotFormat format,
+                         long long interval_ns);
+
+// Запись снимка и сброс интервала; вызывается из stats_record раз в интервал
+void stats_flush_interval(StreamStats *stats, long long now_ns);
+
+// Вставка в top-K; вызывается, только если значение больше минимума кучи
+void stats_push_outlier(StreamStats *stats, uint64_t value, long long now_ns);
+
+/**
+ * @brief Учитывает одну выборку. Не выделяет память.
+ *
+ * @param stats Статистика.
+ * @param value Задержка, нс.
+ * @param now_ns Момент выборки (CLOCK_MONOTONIC), нс.
+ */
+static inline void stats_record(StreamStats *stats, uint64_t value, long long now_ns) {
+    stats->count++;
+    double delta = (double)value - stats->mean;
+    stats->mean += delta / (double)stats->count;
+    stats->m2 += delta * ((double)value - stats->mean);
+    hist_record(&stats->hist, value);
+    hist_record(&stats->interval, value);
+    if (stats->top_count < STATS_TOP_K || value > stats->top[0].value) {
+        stats_push_outlier(stats, value, now_ns);
+    }
+    if (stats->snapshot && now_ns >= stats->next_snapshot_ns) {
+        stats_flush_interval(stats, now_ns);
+    }
+}
+
+/**
+ * @brief Стандартное отклонение (генеральное).
+ */
+double stats_stddev(const StreamStats *stats);
+
+/**
+ * @brief Копирует top-K в out по убыванию задержки.
+ *
+ * @return Число скопированных выборок.
+ */
+int stats_outliers(const StreamStats *stats, StatsOutlier *out);
+
+/**
+ * @brief Записывает последний неполный интервал и закрывает файл снимков.
+ */
+void stats_finish(StreamStats *stats, long long now_ns);
+
+/**
+ * @brief Разбирает имя формата снимков ("csv" или "bin").
+ *
+ * @return 0 при успехе, -1 для неизвестного имени.
+ */
+int stats_parse_format(const char *name, SnapshotFormat *format);
+
+#endif // STREAM_STATS_H
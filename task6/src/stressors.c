@@ -0,0 +1,368 @@
+#define _GNU_SOURCE
+#include "stressors.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "kernels.h"
+
+#define DEFAULT_CACHE_SIZE (64UL * 1024 * 1024)
+#define DEFAULT_FAULT_SIZE (4UL * 1024 * 1024)
+#define DEFAULT_IO_SIZE (16UL * 1024 * 1024)
+#define LINE_SIZE 64
+#define CACHE_CHUNK (256 * 1024)     // Байт буфера за один шаг cache
+#define SYSCALLS_PER_CHUNK 64
+#define IO_BLOCK (64 * 1024)
+
+static const char *kind_names[STRESS_KIND_COUNT] = {
+    "cpu", "cache", "syscall", "pagefault", "timer", "io"
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+typedef struct {
+    const StressSpec *spec;
+    int index;
+    int cpu;                // -1 — без привязки
+    long long end_ns;       // 0 — без ограничения
+    char *buffer;           // Буфер cache
+    size_t cursor;
+    double acc;             // Результат cpu
+    int fd;                 // Текущий файл io
+    size_t written;
+    unsigned file_seq;
+    const char *dir;
+    char *shared_page;      // Страница для TLB shootdown
+    char *io_block;         // Блок записи io
+} Worker;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until(long long deadline) {
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000LL;
+    ts.tv_nsec = deadline % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !stop_requested) {
+    }
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/* --- Шаги нагрузки: каждый занимает десятки микросекунд --- */
+
+static void step_cpu(Worker *w) {
+    double x = w->acc + 1.0;
+    for (int i = 0; i < 10000; i++) {
+        x = x * 1.0000001 + 0.5 / x;
+    }
+    w->acc = x;
+}
+
+static void step_cache(Worker *w) {
+    size_t size = w->spec->size;
+    for (size_t off = 0; off < CACHE_CHUNK; off += LINE_SIZE) {
+        w->buffer[w->cursor] += 1;
+        w->cursor += LINE_SIZE;
+        if (w->cursor >= size) w->cursor = 0;
+    }
+}
+
+static void step_syscall(Worker *w) {
+    (void)w;
+    for (int i = 0; i < SYSCALLS_PER_CHUNK; i++) {
+        syscall(SYS_getppid);
+        syscall(SYS_getuid);
+    }
+}
+
+static void step_pagefault(Worker *w) {
+    size_t size = w->spec->size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return;
+    for (size_t off = 0; off < size; off += page) {
+        p[off] = 1;
+    }
+    munmap(p, size);
+}
+
+static void step_io(Worker *w) {
+    char *block = w->io_block;
+    if (w->fd < 0) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/w%d.%u", w->dir, w->index, w->file_seq++);
+        w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (w->fd < 0) return;
+        // Имя больше не нужно: файл исчезнет при закрытии
+        unlink(path);
+        w->written = 0;
+    }
+    memset(block, (int)(w->written / IO_BLOCK), IO_BLOCK);
+    if (write(w->fd, block, IO_BLOCK) != (ssize_t)IO_BLOCK) {
+        close(w->fd);
+        w->fd = -1;
+        return;
+    }
+    w->written += IO_BLOCK;
+    if (w->written >= w->spec->size) {
+        fsync(w->fd);
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+/* --- Потоки --- */
+
+static int expired(const Worker *w) {
+    return stop_requested || (w->end_ns && now_ns() >= w->end_ns);
+}
+
+// Таймеры: пробуждения с периодом 10 мкс..1 мс; первый поток еще и
+// меняет права общей страницы, вызывая TLB shootdown на ядрах остальных
+static void run_timer(Worker *w) {
+    long long interval = 1000000LL / w->spec->intensity;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    long long next = now_ns();
+    while (!expired(w)) {
+        next += interval;
+        sleep_until(next);
+        if (!w->shared_page) continue;
+        if (w->index == 0) {
+            // Снятие права записи сбрасывает TLB на всех ядрах процесса
+            mprotect(w->shared_page, page, PROT_READ);
+            mprotect(w->shared_page, page, PROT_READ | PROT_WRITE);
+        } else {
+            // Только чтение: запись могла бы попасть в момент PROT_READ
+            (void)*(volatile char *)w->shared_page;
+        }
+    }
+}
+
+// Прочие стрессоры: работа в первой части каждого периода, сон до его конца
+static void run_duty_cycle(Worker *w) {
+    long long busy = STRESS_PERIOD_NS * w->spec->intensity / 100;
+    long long period_start = now_ns();
+    while (!expired(w)) {
+        long long work_until = period_start + busy;
+        do {
+            switch (w->spec->kind) {
+            case STRESS_CPU:       step_cpu(w); break;
+            case STRESS_CACHE:     step_cache(w); break;
+            case STRESS_SYSCALL:   step_syscall(w); break;
+            case STRESS_PAGEFAULT: step_pagefault(w); break;
+            case STRESS_IO:        step_io(w); break;
+            default: break;
+            }
+        } while (now_ns() < work_until && !stop_requested);
+        period_start += STRESS_PERIOD_NS;
+        if (busy < STRESS_PERIOD_NS) sleep_until(period_start);
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = (Worker *)arg;
+    if (w->cpu >= 0) rt_pin_thread(pthread_self(), w->cpu);
+
+    if (w->spec->kind == STRESS_CACHE) {
+        // Буфер заполняется первым касанием на ядре потока
+        w->buffer = mmap(NULL, w->spec->size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (w->buffer == MAP_FAILED) return NULL;
+        memset(w->buffer, 0, w->spec->size);
+    }
+
+    if (w->spec->kind == STRESS_IO) {
+        w->io_block = malloc(IO_BLOCK);
+        if (!w->io_block) return NULL;
+    }
+
+    if (w->spec->kind == STRESS_TIMER) {
+        run_timer(w);
+    } else {
+        run_duty_cycle(w);
+    }
+
+    if (w->buffer) munmap(w->buffer, w->spec->size);
+    if (w->fd >= 0) close(w->fd);
+    free(w->io_block);
+    return NULL;
+}
+
+int stress_run(const StressSpec *spec) {
+    // Нагрузка не должна вытеснять измерение: обычная политика планирования
+    struct sched_param sp;
+    sp.sched_priority = 0;
+    sched_setscheduler(0, SCHED_OTHER, &sp);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    char dir[512] = "";
+    if (spec->kind == STRESS_IO) {
+        snprintf(dir, sizeof(dir), "%s/loadgen.XXXXXX", spec->dir ? spec->dir : "/tmp");
+        if (!mkdtemp(dir)) {
+            perror("mkdtemp failed");
+            return 1;
+        }
+    }
+
+    char *shared_page = NULL;
+    if (spec->kind == STRESS_TIMER && spec->cpu_count > 1) {
+        shared_page = mmap(NULL, (size_t)sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (shared_page == MAP_FAILED) shared_page = NULL;
+    }
+
+    int threads = spec->cpu_count > 0 ? spec->cpu_count : 1;
+    Worker workers[RT_MAX_CPUS];
+    pthread_t handles[RT_MAX_CPUS];
+    long long end = spec->duration_s > 0 ? now_ns() + spec->duration_s * 1000000000LL : 0;
+    for (int i = 0; i < threads; i++) {
+        memset(&workers[i], 0, sizeof(Worker));
+        workers[i].spec = spec;
+        workers[i].index = i;
+        workers[i].cpu = spec->cpu_count > 0 ? spec->cpus[i] : -1;
+        workers[i].end_ns = end;
+        workers[i].fd = -1;
+        workers[i].dir = dir;
+        workers[i].shared_page = shared_page;
+        if (pthread_create(&handles[i], NULL, worker_main, &workers[i]) != 0) {
+            perror("pthread_create failed");
+            threads = i;
+            stop_requested = 1;
+            break;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+
+    if (shared_page) munmap(shared_page, (size_t)sysconf(_SC_PAGESIZE));
+    if (dir[0]) rmdir(dir);
+    return 0;
+}
+
+/* --- Процессы --- */
+
+int stress_start(const StressSpec *specs, int count, StressGroup *group) {
+    group->count = 0;
+    fflush(stdout);
+    for (int i = 0; i < count && i < STRESS_MAX; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork failed");
+            stress_stop(group);
+            return -1;
+        }
+        if (pid == 0) {
+            _exit(stress_run(&specs[i]));
+        }
+        group->pids[group->count++] = pid;
+    }
+    return 0;
+}
+
+void stress_stop(StressGroup *group) {
+    for (int i = 0; i < group->count; i++) {
+        kill(group->pids[i], SIGTERM);
+    }
+    stress_wait(group);
+}
+
+void stress_wait(StressGroup *group) {
+    for (int i = 0; i < group->count; i++) {
+        while (waitpid(group->pids[i], NULL, 0) < 0 && errno == EINTR) {
+        }
+    }
+    group->count = 0;
+}
+
+/* --- Разбор описаний --- */
+
+int stress_parse(char *text, StressSpec *spec) {
+    memset(spec, 0, sizeof(*spec));
+    spec->intensity = 100;
+
+    char *save = NULL;
+    char *token = strtok_r(text, ":", &save);
+    if (!token) return -1;
+    int kind = -1;
+    for (int i = 0; i < STRESS_KIND_COUNT; i++) {
+        if (strcmp(token, kind_names[i]) == 0) kind = i;
+    }
+    if (kind < 0) return -1;
+    spec->kind = (StressKind)kind;
+
+    while ((token = strtok_r(NULL, ":", &save)) != NULL) {
+        char *value = strchr(token, '=');
+        if (!value) return -1;
+        *value++ = '\0';
+        if (strcmp(token, "cpus") == 0) {
+            spec->cpu_count = rt_parse_cpulist(value, spec->cpus, RT_MAX_CPUS);
+            if (spec->cpu_count == 0) return -1;
+        } else if (strcmp(token, "intensity") == 0) {
+            spec->intensity = atoi(value);
+        } else if (strcmp(token, "duration") == 0) {
+            spec->duration_s = atoi(value);
+        } else if (strcmp(token, "size") == 0) {
+            spec->size = kernel_parse_size(value);
+            if (spec->size == 0) return -1;
+        } else if (strcmp(token, "dir") == 0) {
+            spec->dir = value;
+        } else {
+            return -1;
+        }
+    }
+    if (spec->intensity < 1 || spec->intensity > 100 || spec->duration_s < 0) return -1;
+
+    if (spec->size == 0) {
+        switch (spec->kind) {
+        case STRESS_CACHE:     spec->size = DEFAULT_CACHE_SIZE; break;
+        case STRESS_PAGEFAULT: spec->size = DEFAULT_FAULT_SIZE; break;
+        case STRESS_IO:        spec->size = DEFAULT_IO_SIZE; break;
+        default: break;
+        }
+    }
+    return 0;
+}
+
+const char *stress_kind_name(StressKind kind) {
+    return (kind >= 0 && kind < STRESS_KIND_COUNT) ? kind_names[kind] : "unknown";
+}
+
+void stress_describe(const StressSpec *spec) {
+    printf("  %-9s intensity %3d%%", stress_kind_name(spec->kind), spec->intensity);
+    if (spec->cpu_count > 0) {
+        printf(", cpus");
+        for (int i = 0; i < spec->cpu_count; i++) printf("%c%d", i ? ',' : ' ', spec->cpus[i]);
+    } else {
+        printf(", unpinned");
+    }
+    if (spec->size) printf(", size %zu KB", spec->size / 1024);
+    if (spec->kind == STRESS_IO) printf(", dir %s", spec->dir ? spec->dir : "/tmp");
+    if (spec->duration_s > 0) {
+        printf(", %d s\n", spec->duration_s);
+    } else {
+        printf(", until stopped\n");
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef STRESSORS_H
+#define STRESSORS_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "rt_thread.h"
+
+#define STRESS_MAX 16               // Стрессоров в одном запуске
+#define STRESS_PERIOD_NS 10000000LL // Период регулирования нагрузки, 10 мс
+
+/**
+ * @brief Виды фоновой нагрузки.
+ */
+typedef enum {
+    STRESS_CPU,         // Вычислительный цикл
+    STRESS_CACHE,       // Запись по буферу заданного размера (кэш / пропускная способность)
+    STRESS_SYSCALL,     // Поток дешевых системных вызовов
+    STRESS_PAGEFAULT,   // mmap, касание страниц, munmap
+    STRESS_TIMER,       // Частые пробуждения hrtimer и TLB shootdown IPI
+    STRESS_IO,          // Запись и fsync файлов во временном каталоге
+    STRESS_KIND_COUNT
+} StressKind;
+
+/**
+ * @brief Описание одного стрессора.
+ *
+ * Интенсивность — доля каждого 10 мс периода, занятая работой
+ * (для STRESS_TIMER — частота пробуждений: 100 соответствует
+ * периоду 10 мкс, 1 — 1 мс). Работа на каждом ядре из списка
+ * выполняется отдельным закрепленным потоком.
+ */
+typedef struct {
+    StressKind kind;
+    int intensity;          // 1..100
+    int duration_s;         // 0 — до stress_stop()
+    size_t size;            // Рабочий набор cache/pagefault/io, байт
+    const char *dir;        // Каталог для io (по умолчанию /tmp)
+    int cpu_count;          // 0 — один поток без привязки
+    int cpus[RT_MAX_CPUS];
+} StressSpec;
+
+/**
+ * @brief Запущенные стрессоры: по одному дочернему процессу на описание.
+ */
+typedef struct {
+    int count;
+    pid_t pids[STRESS_MAX];
+} StressGroup;
+
+/**
+ * @brief Разбирает описание вида "kind[:cpus=LIST][:intensity=N][:duration=S][:size=SIZE][:dir=PATH]".
+ *
+ * Строка должна жить, пока используется spec (dir указывает в нее).
+ *
+ * @return 0 при успехе, -1 при ошибке разбора.
+ */
+int stress_parse(char *text, StressSpec *spec);
+
+const char *stress_kind_name(StressKind kind);
+
+/**
+ * @brief Печатает описание стрессора в одну строку.
+ */
+void stress_describe(const StressSpec *spec);
+
+/**
+ * @brief Запускает стрессоры в дочерних процессах с политикой SCHED_OTHER.
+ *
+ * @param specs Описания.
+ * @param count Число описаний (не больше STRESS_MAX).
+ * @param group Запущенные процессы.
+ * @return 0 при успехе, -1 если fork не удался (уже запущенные остановлены).
+ */
+int stress_start(const StressSpec *specs, int count, StressGroup *group);
+
+/**
+ * @brief Останавливает стрессоры (SIGTERM) и дожидается их завершения.
+ */
+void stress_stop(StressGroup *group);
+
+/**
+ * @brief Дожидается, пока все стрессоры завершатся сами (по duration).
+ */
+void stress_wait(StressGroup *group);
+
+/**
+ * @brief Выполняет стрессор в текущем процессе до истечения duration или SIGTERM.
+ *
+ * @return Код завершения процесса.
+ */
+int stress_run(const StressSpec *spec);
+
+#endif // STRESSORS_H
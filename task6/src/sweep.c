@@ -0,0 +1,89 @@
+#define _GNU_SOURCE
+#include "sweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+typedef struct {
+    const SweepConfig *config;
+    SweepResult *result;
+    pthread_barrier_t *barrier;
+} SweepThread;
+
+static void *sweep_thread(void *arg) {
+    SweepThread *ctx = (SweepThread *)arg;
+    const SweepConfig *config = ctx->config;
+    SweepResult *result = ctx->result;
+    Kernel kernel;
+    int have_kernel = 0;
+
+    result->error = rt_pin_thread(pthread_self(), result->cpu);
+    if (result->error == 0) {
+        result->error = rt_set_fifo(pthread_self(), config->priority);
+    }
+    if (result->error == 0) {
+        if (kernel_init(&kernel, config->kernel, config->working_set, config->isa) == 0) {
+            have_kernel = 1;
+            kernel.seed = (unsigned)result->cpu + 1;
+            result->working_set = kernel.working_set;
+            result->isa = kernel.isa;
+        } else {
+            result->error = ENOMEM;
+        }
+    }
+    pthread_barrier_wait(ctx->barrier);
+    if (result->error != 0) {
+        if (have_kernel) kernel_destroy(&kernel);
+        return NULL;
+    }
+
+    for (int i = 0; i < config->iterations; i++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        kernel_run(&kernel);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long long ns = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+        hist_record(&result->hist, (uint64_t)ns);
+    }
+    kernel_destroy(&kernel);
+    return NULL;
+}
+
+int sweep_run(const SweepConfig *config, SweepResult *results) {
+    int count = config->cpu_count;
+    pthread_t *threads = malloc(count * sizeof(pthread_t));
+    SweepThread *ctx = malloc(count * sizeof(SweepThread));
+    pthread_barrier_t barrier;
+    if (!threads || !ctx || pthread_barrier_init(&barrier, NULL, (unsigned)count) != 0) {
+        perror("sweep setup failed");
+        free(threads);
+        free(ctx);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i].cpu = config->cpus[i];
+        results[i].error = 0;
+        results[i].working_set = 0;
+        results[i].isa = ISA_SCALAR;
+        hist_init(&results[i].hist);
+        ctx[i].config = config;
+        ctx[i].result = &results[i];
+        ctx[i].barrier = &barrier;
+        if (pthread_create(&threads[i], NULL, sweep_thread, &ctx[i]) != 0) {
+            // Без всех участников барьер не откроется
+            perror("pthread_create failed");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    free(ctx);
+    free(threads);
+    return 0;
+}
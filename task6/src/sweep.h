@@ -0,0 +1,49 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include "latency_hist.h"
+#include "rt_thread.h"
+#include "kernels.h"
+
+/**
+ * @brief Параметры одновременного прогона на нескольких ядрах.
+ */
+typedef struct {
+    KernelId kernel;        // Нагрузка, время которой измеряется
+    size_t working_set;     // Рабочий набор каждого потока (0 — по умолчанию)
+    KernelIsa isa;
+    int iterations;         // Итераций на каждом ядре
+    int priority;           // Приоритет SCHED_FIFO
+    int cpu_count;
+    int cpus[RT_MAX_CPUS];
+} SweepConfig;
+
+/**
+ * @brief Результат одного ядра.
+ */
+typedef struct {
+    int cpu;
+    int error;              // 0 или код ошибки настройки потока
+    size_t working_set;     // Фактический рабочий набор
+    KernelIsa isa;          // Фактический набор инструкций
+    LatencyHist hist;
+} SweepResult;
+
+/**
+ * @brief Запускает на каждом ядре закрепленный поток SCHED_FIFO,
+ * который выполняет нагрузку заданное число раз.
+ *
+ * Каждый поток создает собственный экземпляр нагрузки после
+ * закрепления, поэтому рабочий набор лежит в памяти своего узла.
+ *
+ * Все потоки стартуют одновременно через барьер, поэтому ядра
+ * измеряются при одной и той же фоновой нагрузке.
+ *
+ * @param config Параметры прогона.
+ * @param results Массив из config->cpu_count результатов.
+ * @return 0 при успехе, -1 если не удалось подготовить потоки.
+ */
+int sweep_run(const SweepConfig *config, SweepResult *results);
+
+#endif // SWEEP_H
@@ -0,0 +1,10 @@
+#include "command_queue.h"
+#include <string.h>
+
+void command_queue_init(CommandQueue* queue) {
+    memset(queue->items, 0, sizeof(queue->items));
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->tail_cache = 0;
+    queue->head_cache = 0;
+}
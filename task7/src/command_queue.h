@@ -0,0 +1,69 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define COMMAND_QUEUE_SIZE 256      // Степень двойки
+
+// Команды потока ввода контроллеру
+typedef enum {
+    CMD_PED_NS,                 // Запрос пешехода Север-Юг
+    CMD_PED_EW,                 // Запрос пешехода Запад-Восток
+    CMD_EMERGENCY,              // Включить/выключить режим ЧС
+    CMD_COUNT
+} Command;
+
+/**
+ * @brief Очередь команд без блокировок: один писатель, один читатель.
+ *
+ * Писатель двигает только head, читатель — только tail, поэтому хватает
+ * пары атомарных индексов с release/acquire. Индексы лежат в разных
+ * строках кэша; каждая сторона держит рядом копию чужого индекса и
+ * перечитывает его, только когда очередь по копии пуста или полна.
+ * В отличие от флагов, команды не сливаются: два нажатия «s» подряд —
+ * две команды.
+ */
+typedef struct {
+    _Alignas(64) atomic_uint head;  // Следующая запись (пишет писатель)
+    unsigned int tail_cache;        // Копия tail у писателя
+    _Alignas(64) atomic_uint tail;  // Следующее чтение (пишет читатель)
+    unsigned int head_cache;        // Копия head у читателя
+    _Alignas(64) uint8_t items[COMMAND_QUEUE_SIZE];
+} CommandQueue;
+
+void command_queue_init(CommandQueue* queue);
+
+/**
+ * @brief Кладет команду в очередь (только поток-писатель).
+ *
+ * @return 0 при успехе, -1, если очередь полна.
+ */
+static inline int command_queue_push(CommandQueue* queue, Command command) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head - queue->tail_cache == COMMAND_QUEUE_SIZE) {
+        queue->tail_cache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (head - queue->tail_cache == COMMAND_QUEUE_SIZE) return -1;
+    }
+    queue->items[head & (COMMAND_QUEUE_SIZE - 1)] = (uint8_t)command;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Забирает команду из очереди (только поток-читатель).
+ *
+ * @return 1, если команда записана в command, 0, если очередь пуста.
+ */
+static inline int command_queue_pop(CommandQueue* queue, Command* command) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail == queue->head_cache) {
+        queue->head_cache = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (tail == queue->head_cache) return 0;
+    }
+    *command = (Command)queue->items[tail & (COMMAND_QUEUE_SIZE - 1)];
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+#endif // COMMAND_QUEUE_H
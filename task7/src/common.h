@@ -1,7 +1,9 @@
 #ifndef COMMON_H
 #define COMMON_H
 
-#include <pthread.h>
+#include <stdatomic.h>
+
+#include "command_queue.h"
 
 // Состояния конечного автомата
 typedef enum {
@@ -12,25 +14,17 @@ typedef enum {
     STATE_EW_YELLOW,    // Запад-Восток желтый, Север-Юг красный
     STATE_ALL_RED,      // Всем красный (для безопасности)
     STATE_PED_CROSS,    // Переход для пешеходов
-    STATE_EMERGENCY     // Режим ЧС
+    STATE_EMERGENCY,    // Режим ЧС
+    STATE_COUNT
 } TrafficState;
 
-// Длительности состояний в секундах
-#define GREEN_DURATION 10
-#define YELLOW_DURATION 2
-#define ALL_RED_DURATION 1
-#define PED_CROSS_DURATION 8
+// Длительности состояний задаются в таблице автомата (intersection.c)
 
-// Общая структура для данных, разделяемых между потоками
+// Общая структура для данных, разделяемых между потоками. Мьютекса нет:
+// запросы идут через очередь команд, состояние публикуется атомарно
 typedef struct {
-    pthread_mutex_t mutex;      // Мьютекс для защиты данных
-    TrafficState current_state; // Текущее состояние FSM
-
-    // Флаги запросов от потока ввода
-    int ped_ns_request;         // Запрос пешехода Север-Юг
-    int ped_ew_request;         // Запрос пешехода Запад-Восток
-    int emergency_request;      // Запрос режима ЧС
-
+    atomic_int current_state;   // Текущее состояние FSM (пишет только контроллер)
+    CommandQueue commands;      // Запросы от потока ввода
 } SharedData;
 
 #endif // COMMON_H
@@ -0,0 +1,78 @@
+#include "controller_events.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+int events_init(ControllerEvents* events) {
+    events->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    events->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    events->request_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (events->epoll_fd < 0 || events->timer_fd < 0 || events->request_fd < 0) {
+        events_destroy(events);
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = EVENT_TIMER;
+    if (epoll_ctl(events->epoll_fd, EPOLL_CTL_ADD, events->timer_fd, &ev) != 0) {
+        events_destroy(events);
+        return -1;
+    }
+    ev.data.u32 = EVENT_REQUEST;
+    if (epoll_ctl(events->epoll_fd, EPOLL_CTL_ADD, events->request_fd, &ev) != 0) {
+        events_destroy(events);
+        return -1;
+    }
+    return 0;
+}
+
+int events_arm_timer(ControllerEvents* events, long long delay_ns, long long period_ns) {
+    struct itimerspec its;
+    its.it_value.tv_sec = delay_ns / 1000000000LL;
+    its.it_value.tv_nsec = delay_ns % 1000000000LL;
+    its.it_interval.tv_sec = period_ns / 1000000000LL;
+    its.it_interval.tv_nsec = period_ns % 1000000000LL;
+    // Сброс прежнего срабатывания, которое могло остаться непрочитанным
+    uint64_t expirations;
+    while (read(events->timer_fd, &expirations, sizeof(expirations)) > 0) {
+    }
+    return timerfd_settime(events->timer_fd, 0, &its, NULL);
+}
+
+void events_notify(ControllerEvents* events) {
+    uint64_t one = 1;
+    // write в eventfd атомарна и допустима в обработчике сигнала
+    ssize_t n = write(events->request_fd, &one, sizeof(one));
+    (void)n;
+}
+
+unsigned events_wait(ControllerEvents* events, int timeout_ms) {
+    struct epoll_event ready[2];
+    int n = epoll_wait(events->epoll_fd, ready, 2, timeout_ms);
+    if (n < 0) {
+        return 0; // EINTR: вызывающий проверит флаг завершения
+    }
+
+    unsigned mask = 0;
+    uint64_t value;
+    for (int i = 0; i < n; ++i) {
+        // Вычитывание сбрасывает готовность дескриптора
+        if (ready[i].data.u32 == EVENT_TIMER) {
+            if (read(events->timer_fd, &value, sizeof(value)) > 0) mask |= EVENT_TIMER;
+        } else {
+            if (read(events->request_fd, &value, sizeof(value)) > 0) mask |= EVENT_REQUEST;
+        }
+    }
+    return mask;
+}
+
+void events_destroy(ControllerEvents* events) {
+    if (events->epoll_fd >= 0) close(events->epoll_fd);
+    if (events->timer_fd >= 0) close(events->timer_fd);
+    if (events->request_fd >= 0) close(events->request_fd);
+    events->epoll_fd = events->timer_fd = events->request_fd = -1;
+}
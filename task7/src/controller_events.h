@@ -0,0 +1,63 @@
+#ifndef CONTROLLER_EVENTS_H
+#define CONTROLLER_EVENTS_H
+
+// Биты событий, возвращаемых events_wait
+#define EVENT_TIMER   (1u << 0)  // Истек таймер состояния
+#define EVENT_REQUEST (1u << 1)  // Пришел запрос от потока ввода
+
+/**
+ * @brief Источник событий контроллера: один набор epoll с таймером
+ * timerfd (CLOCK_MONOTONIC) и eventfd для запросов.
+ *
+ * Поток контроллера блокируется в events_wait и не просыпается,
+ * пока не истечет таймер или не придет запрос, поэтому задержка
+ * реакции ограничена только задержкой пробуждения.
+ */
+typedef struct {
+    int epoll_fd;
+    int timer_fd;
+    int request_fd;
+} ControllerEvents;
+
+/**
+ * @brief Создает epoll, timerfd и eventfd.
+ *
+ * @param events Структура для инициализации.
+ * @return 0 при успехе, -1 при ошибке (errno сохраняется).
+ */
+int events_init(ControllerEvents* events);
+
+/**
+ * @brief Взводит таймер состояния.
+ *
+ * @param events Источник событий.
+ * @param delay_ns Задержка до срабатывания в наносекундах (0 — отключить).
+ * @param period_ns Период повторения (0 — однократно).
+ * @return 0 при успехе, -1 при ошибке.
+ */
+int events_arm_timer(ControllerEvents* events, long long delay_ns, long long period_ns);
+
+/**
+ * @brief Будит контроллер. Безопасна для вызова из обработчика сигнала.
+ *
+ * @param events Источник событий.
+ */
+void events_notify(ControllerEvents* events);
+
+/**
+ * @brief Ждет событие.
+ *
+ * @param events Источник событий.
+ * @param timeout_ms Таймаут в миллисекундах (-1 — без таймаута).
+ * @return Маска EVENT_*; 0 при таймауте или прерывании сигналом.
+ */
+unsigned events_wait(ControllerEvents* events, int timeout_ms);
+
+/**
+ * @brief Закрывает дескрипторы.
+ *
+ * @param events Источник событий.
+ */
+void events_destroy(ControllerEvents* events);
+
+#endif // CONTROLLER_EVENTS_H
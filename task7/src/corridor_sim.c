@@ -0,0 +1,501 @@
+/**
+ * @brief Моделирование городского коридора: тысячи автоматов перекрестков
+ * на фиксированном пуле потоков.
+ *
+ * Перекрестки хранятся структурой массивов (состояние, флаги, срок,
+ * смещение волны) и переходят по таблице intersection_table. Каждый поток
+ * владеет непрерывным блоком перекрестков и своим колесом таймеров; на
+ * каждом тике он выдает сработавшие таймеры в очередь готовых, затем все
+ * потоки разбирают очереди порциями, а освободившиеся крадут порции
+ * у соседей. Зеленая волна: начало NS_GREEN каждого перекрестка сдвинуто
+ * от соседа выше по коридору на время проезда, после пешеходной фазы
+ * зеленый укорачивается или продлевается, чтобы вернуться в волну.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "fsm.h"
+#include "intersection.h"
+
+#define TICKS_PER_SECOND 100        // Тик моделирования 10 мс
+#define RING_BITS 12                // 4096 слотов, 41 с моделирования
+#define STEAL_CHUNK 64              // Порция очереди готовых
+#define MAX_LIST 16                 // Значений в списках --intersections / --threads
+#define MAX_THREADS 256
+
+#define FLAG_NS_NEXT (1u << 0)      // Следующим получает зеленый Север-Юг
+#define FLAG_PED     (1u << 1)      // Есть запрос пешехода
+
+// Перекрестки коридора: структура массивов
+typedef struct {
+    int count;
+    uint8_t* state;
+    uint8_t* flags;
+    int64_t* deadline;              // Тик следующего таймаута
+    int32_t* offset;                // Плановое начало NS_GREEN внутри цикла, тики
+    int32_t* next;                  // Связи списков колец таймеров
+} Corridor;
+
+/**
+ * @brief Одноуровневое кольцо сроков одного потока.
+ *
+ * Все длительности состояний короче оборота, поэтому иерархическое колесо
+ * (timer_wheel.h) здесь лишнее: оно раскладывает каждый таймер еще раз при
+ * переходе между уровнями. Связи списков (next) и сроки (deadline) лежат
+ * в массивах коридора, кольцо памяти на таймер не выделяет. Срок дальше
+ * оборота остается в слоте и проверяется на следующих оборотах.
+ */
+typedef struct {
+    int32_t* slots;             // Голова списка слота, -1 — пусто
+    uint32_t mask;              // Число слотов - 1 (степень двойки)
+    int64_t now;                // Последний обработанный тик
+    int32_t* next;
+    const int64_t* deadline;
+} SlotRing;
+
+typedef struct Sim Sim;
+
+typedef struct {
+    Sim* sim;
+    int index;
+    pthread_t thread;
+    int first, last;                // Свои перекрестки [first, last)
+    SlotRing ring;
+    int32_t* ready;                 // Сработавшие на текущем тике
+    int ready_count;
+    unsigned int seed;
+    _Alignas(64) atomic_int cursor; // Следующая неразобранная порция ready
+    _Alignas(64) long long transitions;
+    long long stolen;
+    long long misses;
+    long long max_late_ns;
+    long long busy_ns;
+    long long green_starts;
+    long long on_wave;
+} Worker;
+
+struct Sim {
+    Corridor corridor;
+    FsmDispatch dispatch;
+    int threads;
+    Worker* workers;
+    pthread_barrier_t barrier;
+    long long total_ticks;
+    long long tick_real_ns;         // Реальная длительность тика, 0 — без ограничения
+    long long start_ns;
+    int cycle_ticks;
+    int max_adjust_ticks;           // Наибольшая поправка зеленого за цикл
+    int ped_percent;
+    int corridor_length;
+    int travel_ticks;
+    int duration_ticks[STATE_COUNT];
+};
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until(long long target_ns) {
+    struct timespec ts;
+    ts.tv_sec = target_ns / 1000000000LL;
+    ts.tv_nsec = target_ns % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+static int parse_list(const char* text, int* values) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < MAX_LIST) {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0) return -1;
+        values[count++] = (int)value;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return count;
+}
+
+static int corridor_alloc(Corridor* c, int count) {
+    memset(c, 0, sizeof(*c));
+    c->count = count;
+    c->state = malloc(count);
+    c->flags = malloc(count);
+    c->deadline = malloc(sizeof(int64_t) * count);
+    c->offset = malloc(sizeof(int32_t) * count);
+    c->next = malloc(sizeof(int32_t) * count);
+    return (c->state && c->flags && c->deadline && c->offset && c->next) ? 0 : -1;
+}
+
+static void corridor_free(Corridor* c) {
+    free(c->state);
+    free(c->flags);
+    free(c->deadline);
+    free(c->offset);
+    free(c->next);
+}
+
+// Начальное состояние: NS_GREEN каждого перекрестка приходится на его смещение волны.
+// Коридоры независимы, у каждого свое базовое смещение, иначе все
+// перекрестки с одинаковой позицией срабатывали бы на одном тике
+static void corridor_reset(Sim* sim) {
+    Corridor* c = &sim->corridor;
+    int all_red = sim->duration_ticks[STATE_ALL_RED];
+    for (int id = 0; id < c->count; ++id) {
+        int position = id % sim->corridor_length;
+        uint32_t base = (uint32_t)(id / sim->corridor_length) * 2654435761u;
+        c->offset[id] = (int32_t)((base % sim->cycle_ticks +
+                                   (long long)position * sim->travel_ticks) % sim->cycle_ticks);
+        c->state[id] = STATE_INIT;
+        c->flags[id] = FLAG_NS_NEXT;
+        // INIT истекает за ALL_RED до планового зеленого
+        int64_t first = c->offset[id] - all_red;
+        while (first <= 0) first += sim->cycle_ticks;
+        c->deadline[id] = first;
+    }
+}
+
+static int ring_init(SlotRing* ring, int slot_bits, int32_t* next, const int64_t* deadline) {
+    uint32_t count = 1u << slot_bits;
+    ring->slots = malloc(sizeof(int32_t) * count);
+    if (!ring->slots) return -1;
+    for (uint32_t i = 0; i < count; ++i) ring->slots[i] = -1;
+    ring->mask = count - 1;
+    ring->now = 0;
+    ring->next = next;
+    ring->deadline = deadline;
+    return 0;
+}
+
+// Поставить таймер id на срок deadline[id]; просроченный — на ближайший тик
+static inline void ring_add(SlotRing* ring, int32_t id) {
+    int64_t when = ring->deadline[id];
+    if (when <= ring->now) when = ring->now + 1;
+    uint32_t slot = (uint32_t)when & ring->mask;
+    ring->next[id] = ring->slots[slot];
+    ring->slots[slot] = id;
+}
+
+// Выдать из слота таймеры со сроком не позже tick, остальные оставить
+static int ring_expire_slot(SlotRing* ring, uint32_t slot, int64_t tick, int32_t* out) {
+    int count = 0;
+    int32_t* link = &ring->slots[slot];
+    while (*link != -1) {
+        int32_t id = *link;
+        if (ring->deadline[id] <= tick) {
+            *link = ring->next[id];
+            out[count++] = id;
+        } else {
+            link = &ring->next[id];
+        }
+    }
+    return count;
+}
+
+// Продвинуть кольцо до тика tick и выдать сработавшие
+static int ring_expire(SlotRing* ring, int64_t tick, int32_t* out) {
+    int count = 0;
+    if (tick <= ring->now) return 0;
+
+    // Отставание больше оборота: каждый слот достаточно пройти один раз
+    int64_t first = ring->now + 1;
+    if (tick - first > (int64_t)ring->mask) first = tick - ring->mask;
+    for (int64_t t = first; t <= tick; ++t) {
+        count += ring_expire_slot(ring, (uint32_t)t & ring->mask, tick, out + count);
+    }
+    ring->now = tick;
+    return count;
+}
+
+static void ring_destroy(SlotRing* ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+// Переход перекрестка id по таймауту
+static inline void advance(Worker* w, int32_t id) {
+    Sim* sim = w->sim;
+    Corridor* c = &sim->corridor;
+    IntersectionContext ctx;
+
+    int state = c->state[id];
+    uint8_t flags = c->flags[id];
+    ctx.ns_next = (flags & FLAG_NS_NEXT) != 0;
+    ctx.ped_ew_request = 0;
+    // Пешеход мог нажать кнопку за время состояния
+    ctx.ped_ns_request = (flags & FLAG_PED) || (int)(rand_r(&w->seed) % 100) < sim->ped_percent;
+
+    fsm_fire(&sim->dispatch, &state, EV_TIMER, &ctx);
+
+    int64_t fired = c->deadline[id];
+    int duration = sim->duration_ticks[state];
+    if (state == STATE_NS_GREEN) {
+        // Фаза относительно плана волны: 0 — зеленый точно по смещению
+        int drift = (int)(((fired - c->offset[id]) % sim->cycle_ticks + sim->cycle_ticks) % sim->cycle_ticks);
+        w->green_starts++;
+        if (drift == 0) {
+            w->on_wave++;
+        } else if (drift <= sim->cycle_ticks / 2) {
+            duration -= drift < sim->max_adjust_ticks ? drift : sim->max_adjust_ticks;
+        } else {
+            int early = sim->cycle_ticks - drift;
+            duration += early < sim->max_adjust_ticks ? early : sim->max_adjust_ticks;
+        }
+    }
+
+    // Срок считается от планового, а не фактического момента: опоздание не накапливается
+    c->deadline[id] = fired + duration;
+    c->state[id] = (uint8_t)state;
+    c->flags[id] = (ctx.ns_next ? FLAG_NS_NEXT : 0) | (ctx.ped_ns_request ? FLAG_PED : 0);
+}
+
+// Разобрать очередь готовых victim порциями; w — исполнитель
+static void drain_queue(Worker* w, Worker* victim) {
+    Sim* sim = w->sim;
+    for (;;) {
+        int start = atomic_fetch_add_explicit(&victim->cursor, STEAL_CHUNK, memory_order_relaxed);
+        if (start >= victim->ready_count) break;
+        int end = start + STEAL_CHUNK < victim->ready_count ? start + STEAL_CHUNK : victim->ready_count;
+
+        if (sim->tick_real_ns > 0) {
+            // Опоздание: от планового момента срока до начала обработки порции
+            long long now = now_ns();
+            for (int i = start; i < end; ++i) {
+                long long late = now - (sim->start_ns + sim->corridor.deadline[victim->ready[i]] * sim->tick_real_ns);
+                if (late > sim->tick_real_ns) w->misses++;
+                if (late > w->max_late_ns) w->max_late_ns = late;
+            }
+        }
+        for (int i = start; i < end; ++i) advance(w, victim->ready[i]);
+
+        w->transitions += end - start;
+        if (victim != w) w->stolen += end - start;
+    }
+}
+
+static void* worker_func(void* arg) {
+    Worker* w = (Worker*)arg;
+    Sim* sim = w->sim;
+
+    // Одно колесо на ядро: поток закреплен за своим ядром
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->index % (cpus > 0 ? cpus : 1), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    // Стандартный запас таймера 50 мкс сравним с тиком при ускорении
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    for (long long tick = 1; tick <= sim->total_ticks; ++tick) {
+        if (sim->tick_real_ns > 0) sleep_until(sim->start_ns + tick * sim->tick_real_ns);
+        long long busy_start = now_ns();
+
+        // Перевзвести обработанные на прошлом тике (в том числе украденные) и выдать сработавшие
+        for (int i = 0; i < w->ready_count; ++i) ring_add(&w->ring, w->ready[i]);
+        w->ready_count = ring_expire(&w->ring, tick, w->ready);
+        atomic_store_explicit(&w->cursor, 0, memory_order_relaxed);
+        w->busy_ns += now_ns() - busy_start;
+        pthread_barrier_wait(&sim->barrier);
+
+        busy_start = now_ns();
+        drain_queue(w, w);
+        for (int k = 1; k < sim->threads; ++k) {
+            drain_queue(w, &sim->workers[(w->index + k) % sim->threads]);
+        }
+        w->busy_ns += now_ns() - busy_start;
+        pthread_barrier_wait(&sim->barrier);
+    }
+    return NULL;
+}
+
+static int run_sim(Sim* sim, int threads) {
+    Corridor* c = &sim->corridor;
+    sim->threads = threads;
+    sim->workers = aligned_alloc(64, sizeof(Worker) * threads);
+    if (!sim->workers) return -1;
+    memset(sim->workers, 0, sizeof(Worker) * threads);
+    corridor_reset(sim);
+
+    int status = 0;
+    for (int i = 0; i < threads; ++i) {
+        Worker* w = &sim->workers[i];
+        w->sim = sim;
+        w->index = i;
+        w->first = (int)((long long)c->count * i / threads);
+        w->last = (int)((long long)c->count * (i + 1) / threads);
+        w->seed = 1000 + i;
+        w->ready = malloc(sizeof(int32_t) * (w->last - w->first + 1));
+        if (!w->ready || ring_init(&w->ring, RING_BITS, c->next, c->deadline) != 0) {
+            status = -1;
+            continue;
+        }
+        for (int id = w->first; id < w->last; ++id) ring_add(&w->ring, id);
+    }
+
+    pthread_barrier_init(&sim->barrier, NULL, threads);
+    sim->start_ns = now_ns() + 1000000; // Запас на создание потоков
+    int started = 0;
+    for (int i = 0; i < threads && status == 0; ++i) {
+        if (pthread_create(&sim->workers[i].thread, NULL, worker_func, &sim->workers[i]) != 0) {
+            perror("pthread_create failed");
+            status = -1;
+            break;
+        }
+        started++;
+    }
+    if (status != 0 && started > 0) {
+        // Запущенные потоки ждут на барьере полного пула: завершаем процесс
+        exit(1);
+    }
+    for (int i = 0; i < started; ++i) pthread_join(sim->workers[i].thread, NULL);
+    long long elapsed = now_ns() - sim->start_ns;
+    pthread_barrier_destroy(&sim->barrier);
+
+    if (status == 0) {
+        long long transitions = 0, stolen = 0, misses = 0, max_late = 0, busy = 0, greens = 0, on_wave = 0;
+        for (int i = 0; i < threads; ++i) {
+            Worker* w = &sim->workers[i];
+            transitions += w->transitions;
+            stolen += w->stolen;
+            misses += w->misses;
+            busy += w->busy_ns;
+            greens += w->green_starts;
+            on_wave += w->on_wave;
+            if (w->max_late_ns > max_late) max_late = w->max_late_ns;
+        }
+        printf("%12d %7d %12lld %14.0f %10lld %8.3f %14.1f %9.1f %9.1f %9.1f\n",
+               c->count, threads, transitions, transitions / (elapsed / 1e9), misses,
+               transitions ? 100.0 * misses / transitions : 0.0,
+               max_late / 1000.0,
+               100.0 * busy / ((double)elapsed * threads),
+               transitions ? 100.0 * stolen / transitions : 0.0,
+               greens ? 100.0 * on_wave / greens : 0.0);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        free(sim->workers[i].ready);
+        ring_destroy(&sim->workers[i].ring);
+    }
+    free(sim->workers);
+    sim->workers = NULL;
+    return status;
+}
+
+static void print_usage(const char* name) {
+    printf("Использование: %s [параметры]\n", name);
+    printf("  -n, --intersections LIST  Число перекрестков, через запятую (по умолчанию 10000,100000)\n");
+    printf("  -t, --threads LIST        Размеры пула потоков (по умолчанию 1,2,4)\n");
+    printf("  -d, --duration S          Модельное время, с (по умолчанию 60)\n");
+    printf("  -s, --speed X             Ускорение времени (по умолчанию 100; 0 — без ограничения)\n");
+    printf("  -p, --ped P               Вероятность запроса пешехода за состояние, %% (по умолчанию 2)\n");
+    printf("  -c, --corridor L          Перекрестков в одном коридоре (по умолчанию 20)\n");
+    printf("  -r, --travel S            Время проезда между соседями, с (по умолчанию 4)\n");
+}
+
+int main(int argc, char* argv[]) {
+    int counts[MAX_LIST] = { 10000, 100000 };
+    int count_len = 2;
+    int threads[MAX_LIST] = { 1, 2, 4 };
+    int thread_len = 3;
+    int duration_s = 60;
+    double speed = 100.0;
+
+    Sim sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.ped_percent = 2;
+    sim.corridor_length = 20;
+    int travel_s = 4;
+
+    static const struct option options[] = {
+        { "intersections", required_argument, NULL, 'n' },
+        { "threads", required_argument, NULL, 't' },
+        { "duration", required_argument, NULL, 'd' },
+        { "speed", required_argument, NULL, 's' },
+        { "ped", required_argument, NULL, 'p' },
+        { "corridor", required_argument, NULL, 'c' },
+        { "travel", required_argument, NULL, 'r' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:t:d:s:p:c:r:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'n': count_len = parse_list(optarg, counts); break;
+            case 't': thread_len = parse_list(optarg, threads); break;
+            case 'd': duration_s = atoi(optarg); break;
+            case 's': speed = atof(optarg); break;
+            case 'p': sim.ped_percent = atoi(optarg); break;
+            case 'c': sim.corridor_length = atoi(optarg); break;
+            case 'r': travel_s = atoi(optarg); break;
+            case 'h': print_usage(argv[0]); return 0;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (count_len <= 0 || thread_len <= 0 || duration_s <= 0 || speed < 0 ||
+        sim.ped_percent < 0 || sim.corridor_length <= 0 || travel_s < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    for (int i = 0; i < thread_len; ++i) {
+        if (threads[i] > MAX_THREADS) {
+            printf("Не больше %d потоков\n", MAX_THREADS);
+            return 1;
+        }
+    }
+
+    if (fsm_compile(&intersection_table, &sim.dispatch) == -1) {
+        printf("Таблица переходов не помещается в ограничения FSM\n");
+        return 1;
+    }
+    for (int s = 0; s < STATE_COUNT; ++s) {
+        sim.duration_ticks[s] = fsm_duration(&sim.dispatch, s) * TICKS_PER_SECOND;
+    }
+    // Цикл без пешеходной фазы: ALL_RED, NS зеленый и желтый, ALL_RED, EW зеленый и желтый
+    sim.cycle_ticks = 2 * sim.duration_ticks[STATE_ALL_RED] +
+                      sim.duration_ticks[STATE_NS_GREEN] + sim.duration_ticks[STATE_NS_YELLOW] +
+                      sim.duration_ticks[STATE_EW_GREEN] + sim.duration_ticks[STATE_EW_YELLOW];
+    sim.max_adjust_ticks = sim.duration_ticks[STATE_NS_GREEN] * 3 / 10;
+    sim.travel_ticks = travel_s * TICKS_PER_SECOND;
+    sim.total_ticks = (long long)duration_s * TICKS_PER_SECOND;
+    sim.tick_real_ns = speed > 0 ? (long long)(1e9 / TICKS_PER_SECOND / speed) : 0;
+
+    printf("=== Коридор перекрестков ===\n");
+    printf("Модельное время: %d с, тик %d мс, ускорение: ", duration_s, 1000 / TICKS_PER_SECOND);
+    if (speed > 0) printf("%.0fx (тик %.1f мкс)\n", speed, sim.tick_real_ns / 1000.0);
+    else printf("без ограничения (пропуски не считаются)\n");
+    printf("Цикл: %d с, коридор: %d перекрестков, проезд: %d с, пешеходы: %d%%\n",
+           sim.cycle_ticks / TICKS_PER_SECOND, sim.corridor_length, travel_s, sim.ped_percent);
+    printf("Пропуск: переход обработан позже своего срока больше чем на тик\n\n");
+    printf("перекрестков потоков    переходов    переходов/с  пропусков   проп.%% "
+           "макс.опозд,мкс загрузка%% украдено%%  в волне%%\n");
+
+    for (int i = 0; i < count_len; ++i) {
+        if (corridor_alloc(&sim.corridor, counts[i]) != 0) {
+            perror("malloc failed");
+            corridor_free(&sim.corridor);
+            return 1;
+        }
+        for (int j = 0; j < thread_len; ++j) {
+            if (run_sim(&sim, threads[j]) != 0) {
+                printf("Ошибка запуска: %d перекрестков, %d потоков\n", counts[i], threads[j]);
+            }
+        }
+        corridor_free(&sim.corridor);
+    }
+    return 0;
+}
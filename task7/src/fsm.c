@@ -0,0 +1,41 @@
+#include "fsm.h"
+#include <string.h>
+
+// Добавить переход в строку (state, event); -1 при переполнении строки
+static int add_entry(FsmDispatch* dispatch, int state, const FsmTransition* t) {
+    FsmRow* row = &dispatch->rows[state * FSM_MAX_EVENTS + t->event];
+    if (row->count >= FSM_MAX_ROW) return -1;
+    row->entries[row->count].guard = (uint8_t)t->guard;
+    row->entries[row->count].action = (uint8_t)t->action;
+    row->entries[row->count].to = (uint8_t)t->to;
+    row->count++;
+    return 0;
+}
+
+int fsm_compile(const FsmTable* table, FsmDispatch* dispatch) {
+    memset(dispatch, 0, sizeof(*dispatch));
+    dispatch->table = table;
+    if (table->state_count > FSM_MAX_STATES || table->event_count > FSM_MAX_EVENTS ||
+        table->guard_count > FSM_MAX_GUARDS || table->action_count > FSM_MAX_GUARDS) {
+        return -1;
+    }
+    for (int i = 0; i < table->guard_count; ++i) dispatch->guards[i] = table->guards[i];
+    for (int i = 0; i < table->action_count; ++i) dispatch->actions[i] = table->actions[i];
+    for (int s = 0; s < table->state_count; ++s) dispatch->durations[s] = table->states[s].duration_s;
+
+    // Сначала переходы конкретных состояний: они имеют приоритет над FSM_ANY
+    for (int i = 0; i < table->transition_count; ++i) {
+        const FsmTransition* t = &table->transitions[i];
+        if (t->event < 0 || t->event >= table->event_count) return -1;
+        if (t->guard >= table->guard_count || t->action >= table->action_count) return -1;
+        if (t->from != FSM_ANY && add_entry(dispatch, t->from, t) != 0) return -1;
+    }
+    for (int i = 0; i < table->transition_count; ++i) {
+        const FsmTransition* t = &table->transitions[i];
+        if (t->from != FSM_ANY) continue;
+        for (int s = 0; s < table->state_count; ++s) {
+            if (add_entry(dispatch, s, t) != 0) return -1;
+        }
+    }
+    return 0;
+}
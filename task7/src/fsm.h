@@ -0,0 +1,174 @@
+#ifndef FSM_H
+#define FSM_H
+
+#include <stdint.h>
+
+#define FSM_MAX_STATES 16       // Ограничено проверкой достижимости (16 шагов)
+#define FSM_MAX_EVENTS 8
+#define FSM_MAX_ROW 4           // Переходов на одну пару (состояние, событие)
+#define FSM_MAX_GUARDS 16       // Охранных условий и действий (включая FSM_NONE)
+#define FSM_ANY (-1)            // Переход из любого состояния
+#define FSM_EVENT_TIMEOUT 0     // Событие "истекла длительность состояния"
+#define FSM_NONE 0              // Нет охранного условия / действия
+
+typedef int (*FsmGuard)(void* ctx);
+typedef void (*FsmAction)(void* ctx);
+
+/**
+ * @brief Строка таблицы переходов.
+ *
+ * guard и action — индексы в массивах guards/actions таблицы (0 — нет),
+ * поэтому таблицу можно проверить во время компиляции.
+ */
+typedef struct {
+    int from;       // Состояние или FSM_ANY
+    int event;
+    int guard;
+    int action;
+    int to;
+} FsmTransition;
+
+typedef struct {
+    const char* name;
+    int duration_s;             // Длительность до FSM_EVENT_TIMEOUT
+} FsmState;
+
+/**
+ * @brief Описание автомата: состояния, переходы, охранные условия и действия.
+ *
+ * Переходы для одной пары (состояние, событие) проверяются в порядке
+ * таблицы; строки с FSM_ANY — после строк с конкретным состоянием.
+ */
+typedef struct {
+    const FsmState* states;
+    int state_count;
+    int event_count;
+    int initial;
+    const FsmTransition* transitions;
+    int transition_count;
+    const FsmGuard* guards;
+    int guard_count;
+    const FsmAction* actions;
+    int action_count;
+} FsmTable;
+
+/**
+ * @brief Таблица диспетчеризации: для каждой пары (состояние, событие)
+ * компактный список кандидатов, так что переход — один индекс и
+ * проверка охранных условий без ветвления по состояниям. Условия,
+ * действия и длительности скопированы сюда, чтобы переход не ходил
+ * по указателям в FsmTable.
+ */
+typedef struct {
+    uint8_t count;
+    uint8_t reserved[3];        // Строка ровно 16 байт: индекс — сдвиг
+    struct {
+        uint8_t guard;
+        uint8_t action;
+        uint8_t to;
+    } entries[FSM_MAX_ROW];
+} FsmRow;
+
+typedef struct {
+    const FsmTable* table;
+    FsmGuard guards[FSM_MAX_GUARDS];
+    FsmAction actions[FSM_MAX_GUARDS];
+    int durations[FSM_MAX_STATES];
+    FsmRow rows[FSM_MAX_STATES * FSM_MAX_EVENTS];
+} FsmDispatch;
+
+/**
+ * @brief Строит таблицу диспетчеризации.
+ *
+ * @return 0 при успехе, -1 если таблица не помещается в ограничения.
+ */
+int fsm_compile(const FsmTable* table, FsmDispatch* dispatch);
+
+/**
+ * @brief Обрабатывает событие.
+ *
+ * @param dispatch Таблица диспетчеризации.
+ * @param state Текущее состояние, обновляется при переходе.
+ * @param event Событие.
+ * @param ctx Контекст для охранных условий и действий.
+ * @return 1, если переход выполнен (в том числе в то же состояние), иначе 0.
+ */
+static inline int fsm_fire(const FsmDispatch* dispatch, int* state, int event, void* ctx) {
+    const FsmRow* row = &dispatch->rows[*state * FSM_MAX_EVENTS + event];
+    for (int i = 0; i < row->count; ++i) {
+        int guard = row->entries[i].guard;
+        if (guard != FSM_NONE && !dispatch->guards[guard](ctx)) continue;
+        int action = row->entries[i].action;
+        if (action != FSM_NONE) dispatch->actions[action](ctx);
+        *state = row->entries[i].to;
+        return 1;
+    }
+    return 0;
+}
+
+static inline int fsm_duration(const FsmDispatch* dispatch, int state) {
+    return dispatch->durations[state];
+}
+
+static inline const char* fsm_state_name(const FsmDispatch* dispatch, int state) {
+    return dispatch->table->states[state].name;
+}
+
+/*
+ * Проверки таблицы во время компиляции.
+ *
+ * Таблица объявляется X-макросами:
+ *   STATES(X, arg)      -> X(arg, state, duration_s) ...
+ *   TRANSITIONS(X, arg) -> X(arg, from, event, guard, action, to) ...
+ * FSM_STATIC_CHECK проверяет (сообщения на английском: gcc искажает
+ * кириллицу в диагностике), что номера состояний в пределах,
+ * каждое состояние безусловно обрабатывает FSM_EVENT_TIMEOUT (автомат
+ * не застревает) и все состояния достижимы из начального.
+ */
+#define FSM_OUT_TIMEOUT_(s, from, event, guard, action, to)                         \
+    + (((from) == (s) || (from) == FSM_ANY) && (event) == FSM_EVENT_TIMEOUT && (guard) == FSM_NONE)
+
+#define FSM_CHECK_STATE_(TRANSITIONS, s, duration)                                  \
+    _Static_assert((0 TRANSITIONS(FSM_OUT_TIMEOUT_, s)) > 0,                        \
+                   "FSM: state " #s " has no unguarded timeout transition");        \
+    _Static_assert((duration) > 0, "FSM: state " #s " has zero duration");
+
+#define FSM_CHECK_TRANSITION_(count, from, event, guard, action, to)                \
+    _Static_assert((from) >= FSM_ANY && (from) < (count) && (to) >= 0 && (to) < (count), \
+                   "FSM: state out of range in " #from " -> " #to);
+
+// Один шаг замыкания: добавить состояния, в которые ведут переходы из reach
+#define FSM_REACH_EDGE_(reach, from, event, guard, action, to)                      \
+    | ((((from) == FSM_ANY) ? ((reach) != 0) : (((reach) >> ((from) & 31)) & 1)) << (to))
+#define FSM_REACH_STEP_(TRANSITIONS, reach) ((reach) TRANSITIONS(FSM_REACH_EDGE_, reach))
+
+#define FSM_STATIC_CHECK(name, STATES, TRANSITIONS, initial, count)                 \
+    _Static_assert((count) <= FSM_MAX_STATES, "FSM: too many states");              \
+    STATES(FSM_CHECK_STATE_, TRANSITIONS)                                           \
+    TRANSITIONS(FSM_CHECK_TRANSITION_, count)                                       \
+    enum {                                                                          \
+        name##_reach_0 = 1 << (initial),                                            \
+        name##_reach_1 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_0),              \
+        name##_reach_2 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_1),              \
+        name##_reach_3 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_2),              \
+        name##_reach_4 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_3),              \
+        name##_reach_5 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_4),              \
+        name##_reach_6 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_5),              \
+        name##_reach_7 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_6),              \
+        name##_reach_8 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_7),              \
+        name##_reach_9 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_8),              \
+        name##_reach_10 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_9),             \
+        name##_reach_11 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_10),            \
+        name##_reach_12 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_11),            \
+        name##_reach_13 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_12),            \
+        name##_reach_14 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_13),            \
+        name##_reach_15 = FSM_REACH_STEP_(TRANSITIONS, name##_reach_14)             \
+    };                                                                              \
+    _Static_assert(name##_reach_15 == (1 << (count)) - 1,                           \
+                   "FSM: some states are unreachable from the initial state")
+
+// Строки таблиц для FsmTable, построенные из тех же X-макросов
+#define FSM_STATE_ENTRY(arg, s, duration) [s] = { #s, duration },
+#define FSM_TRANSITION_ENTRY(arg, from, event, guard, action, to) { from, event, guard, action, to },
+
+#endif // FSM_H
@@ -0,0 +1,182 @@
+/**
+ * @brief Микробенчмарк переходов: прежний switch из controller_thread_func
+ * против табличного автомата (fsm_fire).
+ *
+ * Оба варианта получают один и тот же поток событий: таймаут состояния,
+ * изредка запрос пешехода и переключение режима ЧС. Мьютекс, вывод и
+ * таймер исключены, измеряется только логика перехода.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "fsm.h"
+#include "intersection.h"
+
+#define DEFAULT_TRANSITIONS 100000000LL
+#define STREAM_LEN 4096             // Поток событий повторяется по кругу (в L1)
+#define STREAM_PED (1u << 7)        // Перед событием пришел запрос пешехода
+
+// Состояние прежнего автомата: переменные из controller_thread_func
+typedef struct {
+    TrafficState current;
+    TrafficState next_state;
+    int was_in_emergency;
+    int emergency_active;
+    int duration;
+} LegacyFsm;
+
+// Флаги запросов прежнего SharedData
+typedef struct {
+    int ped_ns_request;
+    int ped_ew_request;
+    int emergency_request;
+} LegacyRequests;
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Один проход цикла прежнего контроллера (логика switch без мьютекса и вывода)
+static void legacy_step(LegacyFsm* f, LegacyRequests* shared) {
+    if (shared->emergency_request) {
+        f->emergency_active = !f->emergency_active;
+        shared->emergency_request = 0;
+        if (f->emergency_active) {
+            f->was_in_emergency = 1;
+        } else {
+            f->next_state = STATE_ALL_RED;
+        }
+    }
+
+    if (f->emergency_active) {
+        f->current = STATE_EMERGENCY;
+        f->duration = 1;
+        f->next_state = STATE_ALL_RED;
+        return;
+    }
+
+    f->current = f->next_state;
+    if (f->was_in_emergency) {
+        shared->ped_ns_request = 0;
+        shared->ped_ew_request = 0;
+        f->was_in_emergency = 0;
+    }
+
+    switch (f->next_state) {
+        case STATE_ALL_RED:
+            f->duration = 1;
+            if (shared->ped_ns_request || shared->ped_ew_request) {
+                f->next_state = STATE_PED_CROSS;
+            } else {
+                f->next_state = STATE_NS_GREEN;
+            }
+            break;
+        case STATE_NS_GREEN:
+            f->duration = 10;
+            f->next_state = STATE_NS_YELLOW;
+            break;
+        case STATE_NS_YELLOW:
+            f->duration = 2;
+            f->next_state = STATE_ALL_RED;
+            break;
+        case STATE_EW_GREEN:
+            f->duration = 10;
+            f->next_state = STATE_EW_YELLOW;
+            break;
+        case STATE_EW_YELLOW:
+            f->duration = 2;
+            f->next_state = STATE_ALL_RED;
+            break;
+        case STATE_PED_CROSS:
+            f->duration = 8;
+            shared->ped_ns_request = 0;
+            shared->ped_ew_request = 0;
+            f->next_state = STATE_ALL_RED;
+            break;
+        case STATE_EMERGENCY:
+            f->duration = 1;
+            f->next_state = STATE_EMERGENCY;
+            break;
+        default:
+            f->duration = 1;
+            f->next_state = STATE_ALL_RED;
+            break;
+    }
+}
+
+// Поток событий: EV_TIMER или EV_EMERGENCY, с битом STREAM_PED
+static void build_stream(unsigned char* stream) {
+    unsigned int seed = 2024;
+    for (int i = 0; i < STREAM_LEN; ++i) {
+        int r = rand_r(&seed) % 1000;
+        stream[i] = r < 5 ? EV_EMERGENCY : EV_TIMER;
+        if (rand_r(&seed) % 100 < 3) stream[i] |= STREAM_PED;
+    }
+}
+
+static void report(const char* name, long long transitions, long long elapsed_ns, long long checksum) {
+    printf("%s %14.0f %12.2f   (контрольная сумма %lld)\n",
+           name, transitions / (elapsed_ns / 1e9), (double)elapsed_ns / transitions, checksum);
+}
+
+int main(int argc, char* argv[]) {
+    long long transitions = DEFAULT_TRANSITIONS;
+    if (argc > 1) transitions = atoll(argv[1]);
+    if (transitions <= 0) {
+        printf("Использование: %s [число_переходов]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned char stream[STREAM_LEN];
+    build_stream(stream);
+
+    FsmDispatch dispatch;
+    if (fsm_compile(&intersection_table, &dispatch) == -1) {
+        printf("Таблица переходов не помещается в ограничения FSM\n");
+        return 1;
+    }
+
+    printf("=== Переходы автомата перекрестка ===\n");
+    printf("Переходов: %lld, событий ЧС: 0.5%%, запросов пешеходов: 3%%\n\n", transitions);
+    printf("вариант    переходов/с   нс/переход\n");
+
+    // Прежний switch
+    LegacyRequests shared;
+    memset(&shared, 0, sizeof(shared));
+    LegacyFsm legacy = { STATE_INIT, STATE_ALL_RED, 0, 0, 1 };
+    long long checksum = 0;
+    long long start = now_ns();
+    for (long long i = 0; i < transitions; ++i) {
+        unsigned char e = stream[i & (STREAM_LEN - 1)];
+        if (e & STREAM_PED) shared.ped_ns_request = 1;
+        if ((e & ~STREAM_PED) == EV_EMERGENCY) shared.emergency_request = 1;
+        legacy_step(&legacy, &shared);
+        checksum += legacy.current + legacy.duration;
+    }
+    report("switch ", transitions, now_ns() - start, checksum);
+
+    // Табличный автомат
+    IntersectionContext ctx;
+    intersection_context_init(&ctx);
+    int state = intersection_table.initial;
+    long long fired = 0;
+    checksum = 0;
+    start = now_ns();
+    for (long long i = 0; i < transitions; ++i) {
+        unsigned char e = stream[i & (STREAM_LEN - 1)];
+        if (e & STREAM_PED) ctx.ped_ns_request = 1;
+        fired += fsm_fire(&dispatch, &state, e & ~STREAM_PED, &ctx);
+        checksum += state + fsm_duration(&dispatch, state);
+    }
+    report("таблица", transitions, now_ns() - start, checksum);
+
+    if (fired != transitions) {
+        printf("Внимание: %lld событий не вызвали перехода\n", transitions - fired);
+    }
+    return 0;
+}
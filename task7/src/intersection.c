@@ -0,0 +1,106 @@
+#include "intersection.h"
+
+// Охранные условия
+enum {
+    GUARD_PED_REQUEST = 1,      // Есть запрос пешехода
+    GUARD_NS_NEXT,              // Очередь направления Север-Юг
+    GUARD_COUNT
+};
+
+// Действия при переходе
+enum {
+    ACT_CLEAR_REQUESTS = 1,     // Сбросить запросы пешеходов
+    ACT_NS_DONE,                // Север-Юг отработал, следующий Запад-Восток
+    ACT_EW_DONE,                // Запад-Восток отработал, следующий Север-Юг
+    ACT_COUNT
+};
+
+// Состояния и их длительности в секундах
+#define INTERSECTION_STATES(X, arg)        \
+    X(arg, STATE_INIT,       1)            \
+    X(arg, STATE_NS_GREEN,   10)           \
+    X(arg, STATE_NS_YELLOW,  2)            \
+    X(arg, STATE_EW_GREEN,   10)           \
+    X(arg, STATE_EW_YELLOW,  2)            \
+    X(arg, STATE_ALL_RED,    1)            \
+    X(arg, STATE_PED_CROSS,  8)            \
+    X(arg, STATE_EMERGENCY,  1)
+
+// Переходы: из, событие, условие, действие, в. Для одной пары (состояние,
+// событие) побеждает первая строка с выполненным условием
+#define INTERSECTION_TRANSITIONS(X, arg)                                                          \
+    X(arg, STATE_INIT,      EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_ALL_RED)   \
+    X(arg, STATE_ALL_RED,   EV_TIMER,     GUARD_PED_REQUEST, ACT_CLEAR_REQUESTS, STATE_PED_CROSS) \
+    X(arg, STATE_ALL_RED,   EV_TIMER,     GUARD_NS_NEXT,     FSM_NONE,           STATE_NS_GREEN)  \
+    X(arg, STATE_ALL_RED,   EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_EW_GREEN)  \
+    X(arg, STATE_NS_GREEN,  EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_NS_YELLOW) \
+    X(arg, STATE_NS_YELLOW, EV_TIMER,     FSM_NONE,          ACT_NS_DONE,        STATE_ALL_RED)   \
+    X(arg, STATE_EW_GREEN,  EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_EW_YELLOW) \
+    X(arg, STATE_EW_YELLOW, EV_TIMER,     FSM_NONE,          ACT_EW_DONE,        STATE_ALL_RED)   \
+    X(arg, STATE_PED_CROSS, EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_ALL_RED)   \
+    X(arg, STATE_EMERGENCY, EV_TIMER,     FSM_NONE,          FSM_NONE,           STATE_EMERGENCY) \
+    X(arg, STATE_EMERGENCY, EV_EMERGENCY, FSM_NONE,          ACT_CLEAR_REQUESTS, STATE_ALL_RED)   \
+    X(arg, FSM_ANY,         EV_EMERGENCY, FSM_NONE,          FSM_NONE,           STATE_EMERGENCY)
+
+FSM_STATIC_CHECK(intersection, INTERSECTION_STATES, INTERSECTION_TRANSITIONS, STATE_INIT, STATE_COUNT);
+
+static int guard_ped_request(void* arg) {
+    IntersectionContext* ctx = (IntersectionContext*)arg;
+    return ctx->ped_ns_request || ctx->ped_ew_request;
+}
+
+static int guard_ns_next(void* arg) {
+    return ((IntersectionContext*)arg)->ns_next;
+}
+
+static void act_clear_requests(void* arg) {
+    IntersectionContext* ctx = (IntersectionContext*)arg;
+    ctx->ped_ns_request = 0;
+    ctx->ped_ew_request = 0;
+}
+
+static void act_ns_done(void* arg) {
+    ((IntersectionContext*)arg)->ns_next = 0;
+}
+
+static void act_ew_done(void* arg) {
+    ((IntersectionContext*)arg)->ns_next = 1;
+}
+
+static const FsmState states[STATE_COUNT] = {
+    INTERSECTION_STATES(FSM_STATE_ENTRY, 0)
+};
+
+static const FsmTransition transitions[] = {
+    INTERSECTION_TRANSITIONS(FSM_TRANSITION_ENTRY, 0)
+};
+
+static const FsmGuard guards[GUARD_COUNT] = {
+    [GUARD_PED_REQUEST] = guard_ped_request,
+    [GUARD_NS_NEXT] = guard_ns_next,
+};
+
+static const FsmAction actions[ACT_COUNT] = {
+    [ACT_CLEAR_REQUESTS] = act_clear_requests,
+    [ACT_NS_DONE] = act_ns_done,
+    [ACT_EW_DONE] = act_ew_done,
+};
+
+const FsmTable intersection_table = {
+    .states = states,
+    .state_count = STATE_COUNT,
+    .event_count = EV_COUNT,
+    .initial = STATE_INIT,
+    .transitions = transitions,
+    .transition_count = sizeof(transitions) / sizeof(transitions[0]),
+    .guards = guards,
+    .guard_count = GUARD_COUNT,
+    .actions = actions,
+    .action_count = ACT_COUNT,
+};
+
+void intersection_context_init(IntersectionContext* ctx) {
+    ctx->ped_ns_request = 0;
+    ctx->ped_ew_request = 0;
+    ctx->ns_next = 1;
+}
@@ -0,0 +1,31 @@
+#ifndef INTERSECTION_H
+#define INTERSECTION_H
+
+#include "common.h"
+#include "fsm.h"
+
+// События автомата перекрестка
+typedef enum {
+    EV_TIMER = FSM_EVENT_TIMEOUT,   // Истекла длительность состояния
+    EV_EMERGENCY,                   // Переключение режима ЧС
+    EV_COUNT
+} IntersectionEvent;
+
+/**
+ * @brief Контекст охранных условий и действий перекрестка.
+ *
+ * Принадлежит потоку контроллера: запросы пешеходов он переносит сюда
+ * из очереди команд, поэтому fsm_fire не требует блокировок.
+ */
+typedef struct {
+    int ped_ns_request;         // Запрос пешехода Север-Юг
+    int ped_ew_request;         // Запрос пешехода Запад-Восток
+    int ns_next;                // Следующим получает зеленый Север-Юг
+} IntersectionContext;
+
+// Таблица переходов перекрестка (проверена во время компиляции)
+extern const FsmTable intersection_table;
+
+void intersection_context_init(IntersectionContext* ctx);
+
+#endif // INTERSECTION_H
@@ -0,0 +1,217 @@
+/**
+ * @brief Сравнение задержки реакции контроллера на запрос:
+ * опрос флага через usleep против ожидания в epoll (timerfd + eventfd).
+ *
+ * Поток-инжектор передает запрос так же, как поток ввода: в исходной
+ * схеме — флаг под мьютексом, в новой — команда в очереди без блокировок
+ * и пробуждение через eventfd. Он запоминает момент запроса; поток
+ * контроллера, получив запрос, меняет состояние и запоминает момент смены. Разность — задержка реакции.
+ * Интервалы между запросами случайны, поэтому запросы попадают в разные
+ * фазы цикла опроса (пауза равномерна в пределах периода опроса).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "common.h"
+#include "controller_events.h"
+
+#define DEFAULT_REQUESTS 50
+#define DEFAULT_POLL_US 100000   // Период опроса исходного контроллера
+
+typedef enum {
+    DESIGN_POLLING,
+    DESIGN_EVENTS
+} Design;
+
+typedef struct {
+    Design design;
+    int requests;
+    int poll_us;
+    pthread_mutex_t mutex;          // Исходная схема: флаг запроса под мьютексом
+    int emergency_request;
+    SharedData shared;              // Новая схема: очередь команд
+    ControllerEvents events;
+    sem_t handled;                  // Контроллер обработал запрос
+    volatile int running;
+    long long request_ns;           // Момент последнего запроса
+    long long* latencies;
+    int done;
+    long long wakeups;              // Пробуждений потока контроллера
+} Bench;
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Переключить режим ЧС и записать задержку реакции
+static void toggle_emergency(Bench* bench) {
+    int state = atomic_load_explicit(&bench->shared.current_state, memory_order_relaxed);
+    atomic_store_explicit(&bench->shared.current_state,
+                          state == STATE_EMERGENCY ? STATE_ALL_RED : STATE_EMERGENCY,
+                          memory_order_release);
+    bench->latencies[bench->done++] = now_ns() - bench->request_ns;
+}
+
+// Забрать запрос под мьютексом и сменить состояние; 1, если запрос был
+static int handle_request(Bench* bench) {
+    int taken = 0;
+    pthread_mutex_lock(&bench->mutex);
+    if (bench->emergency_request) {
+        bench->emergency_request = 0;
+        toggle_emergency(bench);
+        taken = 1;
+    }
+    pthread_mutex_unlock(&bench->mutex);
+    return taken;
+}
+
+// Разобрать очередь команд; 1, если была команда ЧС
+static int handle_commands(Bench* bench) {
+    int taken = 0;
+    Command command;
+    while (command_queue_pop(&bench->shared.commands, &command)) {
+        if (command == CMD_EMERGENCY) {
+            toggle_emergency(bench);
+            taken = 1;
+        }
+    }
+    return taken;
+}
+
+// Исходная схема: просыпаться каждые poll_us и проверять флаг
+static void* polling_controller(void* arg) {
+    Bench* bench = (Bench*)arg;
+    while (bench->running) {
+        usleep(bench->poll_us);
+        bench->wakeups++;
+        if (handle_request(bench)) sem_post(&bench->handled);
+    }
+    return NULL;
+}
+
+// Новая схема: спать в epoll, пока не придет событие
+static void* event_controller(void* arg) {
+    Bench* bench = (Bench*)arg;
+    while (bench->running) {
+        unsigned events = events_wait(&bench->events, -1);
+        bench->wakeups++;
+        if ((events & EVENT_REQUEST) && handle_commands(bench)) sem_post(&bench->handled);
+    }
+    return NULL;
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static int run_design(Bench* bench) {
+    pthread_mutex_init(&bench->mutex, NULL);
+    bench->emergency_request = 0;
+    command_queue_init(&bench->shared.commands);
+    atomic_init(&bench->shared.current_state, STATE_ALL_RED);
+    sem_init(&bench->handled, 0, 0);
+    bench->running = 1;
+    bench->done = 0;
+    bench->wakeups = 0;
+
+    pthread_t controller;
+    if (pthread_create(&controller, NULL,
+                       bench->design == DESIGN_POLLING ? polling_controller : event_controller,
+                       bench) != 0) {
+        perror("pthread_create failed");
+        return -1;
+    }
+
+    unsigned int seed = 12345;
+    long long start = now_ns();
+    for (int i = 0; i < bench->requests; ++i) {
+        usleep(1000 + rand_r(&seed) % bench->poll_us);
+
+        if (bench->design == DESIGN_POLLING) {
+            pthread_mutex_lock(&bench->mutex);
+            bench->request_ns = now_ns();
+            bench->emergency_request = 1;
+            pthread_mutex_unlock(&bench->mutex);
+        } else {
+            // Момент запроса публикуется вместе с командой (release в push)
+            bench->request_ns = now_ns();
+            command_queue_push(&bench->shared.commands, CMD_EMERGENCY);
+            events_notify(&bench->events);
+        }
+
+        sem_wait(&bench->handled);
+    }
+    long long elapsed = now_ns() - start;
+
+    bench->running = 0;
+    if (bench->design == DESIGN_EVENTS) events_notify(&bench->events);
+    pthread_join(controller, NULL);
+    sem_destroy(&bench->handled);
+    pthread_mutex_destroy(&bench->mutex);
+
+    qsort(bench->latencies, bench->done, sizeof(long long), compare_ll);
+    long long sum = 0;
+    for (int i = 0; i < bench->done; ++i) sum += bench->latencies[i];
+    int n = bench->done;
+
+    // Подписи выровнены вручную: ширина printf считает байты, а не символы
+    printf("%s %10.1f %10.1f %10.1f %10.1f %10.1f %12.1f\n",
+           bench->design == DESIGN_POLLING ? "опрос" : "epoll",
+           bench->latencies[0] / 1000.0,
+           (double)sum / n / 1000.0,
+           bench->latencies[n / 2] / 1000.0,
+           bench->latencies[(n * 99) / 100 < n ? (n * 99) / 100 : n - 1] / 1000.0,
+           bench->latencies[n - 1] / 1000.0,
+           bench->wakeups / (elapsed / 1e9));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Bench bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.requests = DEFAULT_REQUESTS;
+    bench.poll_us = DEFAULT_POLL_US;
+
+    if (argc > 1) bench.requests = atoi(argv[1]);
+    if (argc > 2) bench.poll_us = atoi(argv[2]);
+    if (bench.requests <= 0 || bench.poll_us <= 0) {
+        printf("Использование: %s [число_запросов] [период_опроса_мкс]\n", argv[0]);
+        return 1;
+    }
+
+    bench.latencies = malloc(sizeof(long long) * bench.requests);
+    if (!bench.latencies) {
+        perror("malloc failed");
+        return 1;
+    }
+    if (events_init(&bench.events) == -1) {
+        perror("events_init failed");
+        free(bench.latencies);
+        return 1;
+    }
+
+    printf("=== Задержка реакции на запрос ===\n");
+    printf("Запросов: %d, период опроса: %d мкс, паузы между запросами: 1000..%d мкс\n\n",
+           bench.requests, bench.poll_us, bench.poll_us + 999);
+    printf("схема   мин, мкс  сред, мкс   p50, мкс   p99, мкс  макс, мкс    пробужд/с\n");
+
+    bench.design = DESIGN_POLLING;
+    int status = run_design(&bench);
+    if (status == 0) {
+        bench.design = DESIGN_EVENTS;
+        status = run_design(&bench);
+    }
+
+    events_destroy(&bench.events);
+    free(bench.latencies);
+    return status == 0 ? 0 : 1;
+}
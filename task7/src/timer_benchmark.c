@@ -0,0 +1,143 @@
+/**
+ * @brief Бенчмарк иерархического колеса таймеров (timer_wheel.h).
+ *
+ * Для каждого числа таймеров измеряет среднюю стоимость взвода, перевзвода
+ * и отмены, а затем ведет колесо модельным временем: на каждом тике
+ * выдает сработавшие таймеры и перевзводит их на случайный срок.
+ * Задержка выдачи партии — время вызовов wheel_expire за один тик
+ * (включая раскладку старших уровней), перевзвод в нее не входит.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "timer_wheel.h"
+
+#define MAX_LIST 16
+#define HORIZON_TICKS 65536         // Сроки таймеров: 1..HORIZON_TICKS тиков
+#define RUN_TICKS 65536             // Тиков в замере выдачи партий
+#define BATCH 1024                  // Размер буфера wheel_expire
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Список через запятую: 1000,10000
+static int parse_list(const char* text, int* values) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < MAX_LIST) {
+        values[count] = atoi(p);
+        if (values[count] <= 0) return -1;
+        count++;
+        p = strchr(p, ',');
+        if (!p) break;
+        p++;
+    }
+    return count;
+}
+
+static int64_t random_delay(unsigned int* seed) {
+    return 1 + rand_r(seed) % HORIZON_TICKS;
+}
+
+static int run(int count) {
+    TimerWheel wheel;
+    int32_t* ids = malloc(sizeof(int32_t) * count);
+    int64_t* expires = malloc(sizeof(int64_t) * count);
+    int32_t* out = malloc(sizeof(int32_t) * BATCH);
+    long long* latencies = malloc(sizeof(long long) * RUN_TICKS);
+    if (!ids || !expires || !out || !latencies || wheel_init(&wheel, count, 1000000LL) != 0) {
+        perror("malloc failed");
+        free(ids);
+        free(expires);
+        free(out);
+        free(latencies);
+        return -1;
+    }
+
+    // Случайные идентификаторы и сроки готовятся заранее, чтобы rand_r не попал в замер
+    unsigned int seed = 2024;
+    for (int i = 0; i < count; ++i) ids[i] = i;
+    for (int i = count - 1; i > 0; --i) {
+        int j = rand_r(&seed) % (i + 1);
+        int32_t t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+    for (int i = 0; i < count; ++i) expires[i] = random_delay(&seed);
+
+    long long start = now_ns();
+    for (int i = 0; i < count; ++i) wheel_arm(&wheel, ids[i], expires[i]);
+    double arm_ns = (double)(now_ns() - start) / count;
+
+    // Перевзвод уже взведенных: снять из старого слота и положить в новый
+    for (int i = 0; i < count; ++i) expires[i] = random_delay(&seed);
+    start = now_ns();
+    for (int i = 0; i < count; ++i) wheel_arm(&wheel, ids[i], expires[i]);
+    double rearm_ns = (double)(now_ns() - start) / count;
+
+    start = now_ns();
+    for (int i = 0; i < count; ++i) wheel_cancel(&wheel, ids[count - 1 - i]);
+    double cancel_ns = (double)(now_ns() - start) / count;
+
+    // Выдача партий в установившемся режиме: сработавший сразу перевзводится
+    for (int i = 0; i < count; ++i) wheel_arm(&wheel, i, random_delay(&seed));
+    long long fired = 0;
+    for (int64_t tick = 0; tick < RUN_TICKS; ++tick) {
+        long long elapsed = 0;
+        for (;;) {
+            long long batch_start = now_ns();
+            int n = wheel_expire(&wheel, tick, out, BATCH);
+            elapsed += now_ns() - batch_start;
+            if (n == 0) break;
+            fired += n;
+            for (int i = 0; i < n; ++i) wheel_arm(&wheel, out[i], tick + random_delay(&seed));
+        }
+        latencies[tick] = elapsed;
+    }
+    qsort(latencies, RUN_TICKS, sizeof(long long), compare_ll);
+
+    printf("%9d %9.1f %11.1f %9.1f %11.1f %9.2f %9.2f %10.2f\n",
+           count, arm_ns, rearm_ns, cancel_ns,
+           (double)fired / RUN_TICKS,
+           latencies[RUN_TICKS / 2] / 1000.0,
+           latencies[(RUN_TICKS * 99) / 100] / 1000.0,
+           latencies[RUN_TICKS - 1] / 1000.0);
+
+    wheel_destroy(&wheel);
+    free(ids);
+    free(expires);
+    free(out);
+    free(latencies);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int counts[MAX_LIST] = { 1000, 10000, 100000, 1000000 };
+    int count = 4;
+    if (argc > 1) count = parse_list(argv[1], counts);
+    if (count <= 0) {
+        printf("Использование: %s [число_таймеров,...]\n", argv[0]);
+        return 1;
+    }
+
+    printf("=== Колесо таймеров: %d уровней по %d слотов ===\n", WHEEL_LEVELS, WHEEL_LEVEL_SLOTS);
+    printf("Сроки: 1..%d тиков, замер выдачи: %d тиков модельного времени\n\n",
+           HORIZON_TICKS, RUN_TICKS);
+    // Подписи выровнены вручную: ширина printf считает байты, а не символы
+    printf(" таймеров  взвод,нс перевзвод,нс отмена,нс партия,шт  p50,мкс  p99,мкс  макс,мкс\n");
+    for (int i = 0; i < count; ++i) {
+        if (run(counts[i]) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LEVEL_MASK (WHEEL_LEVEL_SLOTS - 1)
+#define WHEEL_RANGE (1LL << (WHEEL_LEVEL_BITS * WHEEL_LEVELS))
+#define READY_POSITION (WHEEL_LEVELS * WHEEL_LEVEL_SLOTS) // Позиция списка готовых
+
+static long long monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Узел-заголовок слота и списка готовых к выдаче
+static inline int32_t slot_head(const TimerWheel* wheel, int level, int64_t slot) {
+    return wheel->capacity + level * WHEEL_LEVEL_SLOTS + (int32_t)(slot & LEVEL_MASK);
+}
+
+static inline int32_t ready_head(const TimerWheel* wheel) {
+    return wheel->capacity + READY_POSITION;
+}
+
+static inline int list_empty(const TimerWheel* wheel, int32_t head) {
+    return wheel->nodes[head].next == head;
+}
+
+// Позиция слота: уровень * 64 + индекс
+static inline int slot_position(const TimerWheel* wheel, int32_t head) {
+    return head - wheel->capacity;
+}
+
+static inline void link_tail(TimerWheel* wheel, int32_t head, int32_t id) {
+    int position = slot_position(wheel, head);
+    wheel->nodes[id].slot = (uint16_t)position;
+    if (position < READY_POSITION) {
+        wheel->occupied[position / WHEEL_LEVEL_SLOTS] |= 1ULL << (position % WHEEL_LEVEL_SLOTS);
+    }
+    int32_t last = wheel->nodes[head].prev;
+    wheel->nodes[last].next = id;
+    wheel->nodes[id].prev = last;
+    wheel->nodes[id].next = head;
+    wheel->nodes[head].prev = id;
+}
+
+// Убрать таймер из списка. После выдачи в список готовых slot указывает
+// на прежний слот; бит снимается, только если тот слот действительно пуст
+static inline void unlink_node(TimerWheel* wheel, int32_t id) {
+    WheelNode* node = &wheel->nodes[id];
+    wheel->nodes[node->prev].next = node->next;
+    wheel->nodes[node->next].prev = node->prev;
+    node->next = -1;
+    node->prev = -1;
+    int position = node->slot;
+    if (position < READY_POSITION && list_empty(wheel, wheel->capacity + position)) {
+        wheel->occupied[position / WHEEL_LEVEL_SLOTS] &= ~(1ULL << (position % WHEEL_LEVEL_SLOTS));
+    }
+}
+
+static inline uint64_t rotate_right(uint64_t bits, int count) {
+    return count ? (bits >> count) | (bits << (64 - count)) : bits;
+}
+
+// Положить таймер в слот по сроку относительно now
+static void place(TimerWheel* wheel, int32_t id) {
+    int64_t expires = wheel->nodes[id].expires;
+    int64_t delta = expires - wheel->now;
+    int level = 0;
+    if (delta < 0) {
+        // Тик срока уже обработан: сразу к выдаче
+        link_tail(wheel, ready_head(wheel), id);
+        return;
+    }
+    if (delta > 0) {
+        if (delta >= WHEEL_RANGE) {
+            // Дальше колеса: ждать на старшем уровне и разложиться заново
+            delta = WHEEL_RANGE - 1;
+            expires = wheel->now + delta;
+        }
+        level = (63 - __builtin_clzll((unsigned long long)delta)) / WHEEL_LEVEL_BITS;
+    }
+    link_tail(wheel, slot_head(wheel, level, expires >> (WHEEL_LEVEL_BITS * level)), id);
+}
+
+// Разложить текущий слот уровня level вниз; возвращает индекс слота
+static int cascade(TimerWheel* wheel, int level) {
+    int64_t slot = (wheel->now >> (WHEEL_LEVEL_BITS * level)) & LEVEL_MASK;
+    int32_t head = slot_head(wheel, level, slot);
+    if (list_empty(wheel, head)) return (int)slot;
+
+    // Список снимается целиком: соседей по слоту не нужно переписывать
+    int32_t id = wheel->nodes[head].next;
+    wheel->nodes[head].next = head;
+    wheel->nodes[head].prev = head;
+    wheel->occupied[level] &= ~(1ULL << slot);
+    while (id != head) {
+        int32_t next = wheel->nodes[id].next;
+        place(wheel, id);
+        id = next;
+    }
+    return (int)slot;
+}
+
+// Перенести весь список head в конец списка готовых
+static void splice_ready(TimerWheel* wheel, int32_t head) {
+    if (list_empty(wheel, head)) return;
+    int32_t ready = ready_head(wheel);
+    int32_t first = wheel->nodes[head].next;
+    int32_t last = wheel->nodes[head].prev;
+    int32_t tail = wheel->nodes[ready].prev;
+    wheel->nodes[tail].next = first;
+    wheel->nodes[first].prev = tail;
+    wheel->nodes[last].next = ready;
+    wheel->nodes[ready].prev = last;
+    wheel->nodes[head].next = head;
+    wheel->nodes[head].prev = head;
+    int position = slot_position(wheel, head);
+    wheel->occupied[position / WHEEL_LEVEL_SLOTS] &= ~(1ULL << (position % WHEEL_LEVEL_SLOTS));
+}
+
+int wheel_init(TimerWheel* wheel, int capacity, long long tick_ns) {
+    int nodes = capacity + WHEEL_LEVELS * WHEEL_LEVEL_SLOTS + 1;
+    wheel->capacity = capacity;
+    wheel->now = 0;
+    wheel->tick_ns = tick_ns;
+    wheel->armed = 0;
+    memset(wheel->occupied, 0, sizeof(wheel->occupied));
+    wheel->nodes = malloc(sizeof(WheelNode) * nodes);
+    if (!wheel->nodes) return -1;
+    for (int i = 0; i < capacity; ++i) {
+        wheel->nodes[i].expires = 0;
+        wheel->nodes[i].next = -1;
+        wheel->nodes[i].prev = -1;
+        wheel->nodes[i].slot = 0;
+    }
+    for (int i = capacity; i < nodes; ++i) {
+        wheel->nodes[i].expires = 0;
+        wheel->nodes[i].next = i;
+        wheel->nodes[i].prev = i;
+        wheel->nodes[i].slot = (uint16_t)(i - capacity);
+    }
+    pthread_mutex_init(&wheel->mutex, NULL);
+    wheel->start_ns = monotonic_ns();
+    return 0;
+}
+
+int64_t wheel_current_tick(const TimerWheel* wheel) {
+    return (monotonic_ns() - wheel->start_ns) / wheel->tick_ns;
+}
+
+long long wheel_ns_until(const TimerWheel* wheel, int64_t tick) {
+    long long delay = wheel->start_ns + tick * wheel->tick_ns - monotonic_ns();
+    return delay > 0 ? delay : 1;
+}
+
+void wheel_arm(TimerWheel* wheel, int32_t id, int64_t expires) {
+    pthread_mutex_lock(&wheel->mutex);
+    if (wheel->nodes[id].prev != -1) {
+        unlink_node(wheel, id);
+    } else {
+        wheel->armed++;
+    }
+    wheel->nodes[id].expires = expires;
+    place(wheel, id);
+    pthread_mutex_unlock(&wheel->mutex);
+}
+
+int wheel_cancel(TimerWheel* wheel, int32_t id) {
+    int was_armed = 0;
+    pthread_mutex_lock(&wheel->mutex);
+    if (wheel->nodes[id].prev != -1) {
+        unlink_node(wheel, id);
+        wheel->armed--;
+        was_armed = 1;
+    }
+    pthread_mutex_unlock(&wheel->mutex);
+    return was_armed;
+}
+
+int wheel_expire(TimerWheel* wheel, int64_t tick, int32_t* out, int max) {
+    int count = 0;
+    int32_t ready = ready_head(wheel);
+    pthread_mutex_lock(&wheel->mutex);
+    for (;;) {
+        // Готовые выдаются проходом по списку, заголовок чинится один раз
+        int32_t id = wheel->nodes[ready].next;
+        int taken = count;
+        while (count < max && id != ready) {
+            WheelNode* node = &wheel->nodes[id];
+            out[count++] = id;
+            id = node->next;
+            node->next = -1;
+            node->prev = -1;
+        }
+        wheel->nodes[ready].next = id;
+        wheel->nodes[id].prev = ready;
+        wheel->armed -= count - taken;
+        if (count == max || wheel->now > tick) break;
+        if (wheel->armed == 0) {
+            // Пустое колесо: пропустить тики разом
+            wheel->now = tick + 1;
+            break;
+        }
+
+        int index = (int)(wheel->now & LEVEL_MASK);
+        if (index == 0) {
+            for (int level = 1; level < WHEEL_LEVELS && cascade(wheel, level) == 0; ++level) {
+            }
+        }
+        splice_ready(wheel, slot_head(wheel, 0, index));
+
+        // Пустые тики пропускаются до следующего занятого слота или конца оборота
+        uint64_t later = index == LEVEL_MASK ? 0 : wheel->occupied[0] & (~0ULL << (index + 1));
+        int64_t step = later ? __builtin_ctzll(later) - index : WHEEL_LEVEL_SLOTS - index;
+        wheel->now = wheel->now + step <= tick ? wheel->now + step : tick + 1;
+    }
+    pthread_mutex_unlock(&wheel->mutex);
+    return count;
+}
+
+int64_t wheel_next_expiry(TimerWheel* wheel) {
+    int64_t best = WHEEL_NEVER;
+    pthread_mutex_lock(&wheel->mutex);
+    if (wheel->armed == 0) {
+        best = WHEEL_NEVER;
+    } else if (!list_empty(wheel, ready_head(wheel))) {
+        best = wheel->now - 1; // Уже сработали, ждут выдачи
+    } else {
+        // Слот now + i младшего уровня — ровно тик now + i
+        uint64_t bits = rotate_right(wheel->occupied[0], (int)(wheel->now & LEVEL_MASK));
+        if (bits) best = wheel->now + __builtin_ctzll(bits);
+
+        for (int level = 1; level < WHEEL_LEVELS; ++level) {
+            int shift = WHEEL_LEVEL_BITS * level;
+            int64_t block = wheel->now >> shift;
+            bits = rotate_right(wheel->occupied[level], (int)(block & LEVEL_MASK));
+            if (!bits) continue;
+            int64_t offset;
+            if ((wheel->now & ((1LL << shift) - 1)) == 0) {
+                // На границе блока текущий слот раскладывается этим же тиком
+                offset = __builtin_ctzll(bits);
+            } else if (bits & ~1ULL) {
+                offset = __builtin_ctzll(bits & ~1ULL);
+            } else {
+                offset = WHEEL_LEVEL_SLOTS; // Только текущий слот: следующий оборот
+            }
+            int64_t when = (block + offset) << shift;
+            if (when < best) best = when;
+        }
+    }
+    pthread_mutex_unlock(&wheel->mutex);
+    return best;
+}
+
+void wheel_destroy(TimerWheel* wheel) {
+    pthread_mutex_destroy(&wheel->mutex);
+    free(wheel->nodes);
+    wheel->nodes = NULL;
+}
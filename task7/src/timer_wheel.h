@@ -0,0 +1,110 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define WHEEL_LEVEL_BITS 6                          // 64 слота на уровень
+#define WHEEL_LEVEL_SLOTS (1 << WHEEL_LEVEL_BITS)
+#define WHEEL_LEVELS 5                              // Дальность 2^30 тиков
+#define WHEEL_NEVER INT64_MAX                       // Нет взведенных таймеров
+
+/**
+ * @brief Узел списка слота. Поля таймера лежат вместе, чтобы взвод
+ * и отмена затрагивали одну строку кэша.
+ */
+typedef struct {
+    int64_t expires;
+    int32_t next;
+    int32_t prev;               // -1 — таймер не взведен
+    uint16_t slot;              // Слот таймера (уровень * 64 + индекс)
+} WheelNode;
+
+/**
+ * @brief Иерархическое колесо таймеров.
+ *
+ * Таймеры — идентификаторы 0..capacity-1, память под все выделяется
+ * в wheel_init. Уровень k хранит таймеры со сроком через 64^k..64^(k+1)
+ * тиков; когда младший уровень делает оборот, слот старшего уровня
+ * раскладывается вниз. Взвод, отмена и выдача сработавшего таймера —
+ * O(1): слоты — двусвязные списки на индексах с узлами-заголовками.
+ * Битовые карты непустых слотов позволяют перескакивать пустые тики
+ * и находить ближайший срок без обхода слотов.
+ *
+ * Тики отсчитываются от момента wheel_init по CLOCK_MONOTONIC
+ * (wheel_current_tick), но wheel_expire принимает тик явно, поэтому
+ * колесо можно вести и модельным временем. Все функции берут мьютекс
+ * колеса: взводить и отменять можно из любого потока, продвигает колесо
+ * один поток. Взведя таймер из другого потока, разбудите его, чтобы он
+ * перепрограммировал источник тиков по wheel_next_expiry.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    int capacity;
+    int64_t now;                // Следующий необработанный тик
+    long long tick_ns;
+    long long start_ns;         // CLOCK_MONOTONIC тика 0
+    int armed;                  // Взведенных таймеров (включая готовые к выдаче)
+    uint64_t occupied[WHEEL_LEVELS]; // Непустые слоты уровня, по биту на слот
+    // Узлы 0..capacity-1 — таймеры, далее заголовки слотов и списка готовых
+    WheelNode* nodes;
+} TimerWheel;
+
+/**
+ * @brief Создает колесо.
+ *
+ * @param wheel Колесо.
+ * @param capacity Число таймеров.
+ * @param tick_ns Длительность тика для wheel_current_tick.
+ * @return 0 при успехе, -1 при ошибке.
+ */
+int wheel_init(TimerWheel* wheel, int capacity, long long tick_ns);
+
+/**
+ * @brief Текущий тик по CLOCK_MONOTONIC.
+ */
+int64_t wheel_current_tick(const TimerWheel* wheel);
+
+/**
+ * @brief Наносекунды от текущего момента до начала тика (не меньше 1).
+ */
+long long wheel_ns_until(const TimerWheel* wheel, int64_t tick);
+
+/**
+ * @brief Взводит таймер id на тик expires; уже взведенный перевзводится.
+ * Прошедший срок выдается ближайшим wheel_expire.
+ */
+void wheel_arm(TimerWheel* wheel, int32_t id, int64_t expires);
+
+/**
+ * @brief Отменяет таймер.
+ *
+ * @return 1, если таймер был взведен, иначе 0.
+ */
+int wheel_cancel(TimerWheel* wheel, int32_t id);
+
+/**
+ * @brief Продвигает колесо до тика tick включительно и выдает сработавшие.
+ *
+ * Выдает не больше max таймеров за вызов; остальные ждут следующего
+ * вызова, поэтому вызывайте, пока результат не станет 0. Между вызовами
+ * таймеры можно перевзводить и отменять.
+ *
+ * @return Число идентификаторов в out.
+ */
+int wheel_expire(TimerWheel* wheel, int64_t tick, int32_t* out, int max);
+
+/**
+ * @brief Тик, к которому нужно разбудить владельца колеса.
+ *
+ * Для таймеров младшего уровня это их точный срок, для старших — момент
+ * раскладки их слота (не позже срока). После wheel_expire в этот
+ * момент значение уточняется.
+ *
+ * @return Тик или WHEEL_NEVER, если взведенных таймеров нет.
+ */
+int64_t wheel_next_expiry(TimerWheel* wheel);
+
+void wheel_destroy(TimerWheel* wheel);
+
+#endif // TIMER_WHEEL_H
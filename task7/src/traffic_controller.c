@@ -8,39 +8,50 @@
 #include <errno.h>
 
 #include "common.h"
+#include "controller_events.h"
+#include "intersection.h"
+#include "timer_wheel.h"
+
+#define CONTROLLER_TICK_NS 1000000LL // Тик колеса таймеров, 1 мс
+
+// Таймеры контроллера в колесе
+enum {
+    TIMER_STATE,                // Длительность текущего состояния
+    TIMER_COUNT
+};
 
 // Глобальные переменные
 SharedData shared_data;
-timer_t timer;
-volatile sig_atomic_t timer_expired = 0;
-volatile sig_atomic_t emergency_active = 0;
+ControllerEvents controller_events; // Источник тиков и запросы ввода
+TimerWheel controller_timers;       // Таймеры контроллера
+FsmDispatch intersection;           // Таблица переходов перекрестка
 
 // Флаг для выхода из программы
 volatile sig_atomic_t program_running = 1;
 
-// Обработчик сигнала от таймера
-void timer_handler(int sig) {
-    timer_expired = 1;
-}
-
 // Обработчик Ctrl+C для корректного завершения
 void sigint_handler(int sig) {
+    (void)sig;
     program_running = 0;
+    events_notify(&controller_events);
 }
 
-// Функция для установки таймера
-void set_timer(int seconds) {
-    struct itimerspec its;
-    its.it_value.tv_sec = seconds;
-    its.it_value.tv_nsec = 0;
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;
-    
-    if (timer_settime(timer, 0, &its, NULL) == -1) {
-        perror("timer_settime failed");
+// Запрограммировать timerfd на ближайший срок в колесе (единственный источник тиков)
+void program_tick_source() {
+    int64_t next = wheel_next_expiry(&controller_timers);
+    long long delay = next == WHEEL_NEVER ? 0 : wheel_ns_until(&controller_timers, next);
+    if (events_arm_timer(&controller_events, delay, 0) == -1) {
+        perror("timerfd_settime failed");
     }
 }
 
+// Функция для установки таймера состояния
+void set_timer(int seconds) {
+    int64_t now = wheel_current_tick(&controller_timers);
+    wheel_arm(&controller_timers, TIMER_STATE, now + seconds * (1000000000LL / CONTROLLER_TICK_NS));
+    program_tick_source();
+}
+
 // Функция для красивого вывода текущего состояния светофоров
 void print_lights(TrafficState state) {
     time_t now;
@@ -82,165 +93,86 @@ void print_lights(TrafficState state) {
     }
 }
 
-// Функция проверки запросов пешеходов
-int check_pedestrian_requests() {
-    if (shared_data.ped_ns_request || shared_data.ped_ew_request) {
-        return 1;
+// Обработать событие автомата, опубликовать состояние и взвести его таймер.
+// Вывод идет без блокировок: поток ввода не ждет терминал
+static void controller_step(int* state, int event, IntersectionContext* ctx) {
+    if (fsm_fire(&intersection, state, event, ctx)) {
+        atomic_store_explicit(&shared_data.current_state, *state, memory_order_release);
+        print_lights((TrafficState)*state);
+        set_timer(fsm_duration(&intersection, *state));
     }
-    return 0;
 }
 
-// Функция сброса запросов пешеходов
-void reset_pedestrian_requests() {
-    shared_data.ped_ns_request = 0;
-    shared_data.ped_ew_request = 0;
+// Разобрать очередь команд от потока ввода
+static void drain_commands(int* state, IntersectionContext* ctx) {
+    Command command;
+    while (command_queue_pop(&shared_data.commands, &command)) {
+        switch (command) {
+            // Запросы пешеходов только записаны: их проверит условие в ALL_RED
+            case CMD_PED_NS:
+                ctx->ped_ns_request = 1;
+                break;
+            case CMD_PED_EW:
+                ctx->ped_ew_request = 1;
+                break;
+            case CMD_EMERGENCY:
+                controller_step(state, EV_EMERGENCY, ctx);
+                break;
+            default:
+                break;
+        }
+    }
 }
 
 // Функция потока контроллера (FSM)
 void* controller_thread_func(void* arg) {
-    TrafficState next_state = STATE_ALL_RED;
-    int was_in_emergency = 0;
+    (void)arg;
+    IntersectionContext ctx;
+    intersection_context_init(&ctx);
+    int state = intersection_table.initial;
     
     // Начальная инициализация
-    pthread_mutex_lock(&shared_data.mutex);
-    shared_data.current_state = STATE_INIT;
-    print_lights(shared_data.current_state);
-    pthread_mutex_unlock(&shared_data.mutex);
-    
-    sleep(1); // Краткая пауза для инициализации
+    atomic_store_explicit(&shared_data.current_state, state, memory_order_release);
+    print_lights((TrafficState)state);
+    set_timer(fsm_duration(&intersection, state));
     
+    // Поток спит в epoll; все переходы, включая режим ЧС, задает таблица
     while (program_running) {
-        // Проверка режима ЧС
-        pthread_mutex_lock(&shared_data.mutex);
-        if (shared_data.emergency_request) {
-            emergency_active = !emergency_active;
-            shared_data.emergency_request = 0;
-            
-            if (emergency_active) {
-                next_state = STATE_EMERGENCY;
-                was_in_emergency = 1;
-            } else {
-                // Выход из режима ЧС
-                next_state = STATE_ALL_RED;
-            }
-        }
-        pthread_mutex_unlock(&shared_data.mutex);
+        unsigned events = events_wait(&controller_events, -1);
         
-        // Если активен режим ЧС
-        if (emergency_active) {
-            pthread_mutex_lock(&shared_data.mutex);
-            shared_data.current_state = STATE_EMERGENCY;
-            print_lights(shared_data.current_state);
-            pthread_mutex_unlock(&shared_data.mutex);
-            
-            // Мигаем красным в режиме ЧС
-            while (emergency_active && program_running) {
-                print_lights(STATE_EMERGENCY);
-                sleep(1);
-                pthread_mutex_lock(&shared_data.mutex);
-                if (shared_data.emergency_request) {
-                    emergency_active = !emergency_active;
-                    shared_data.emergency_request = 0;
-                }
-                pthread_mutex_unlock(&shared_data.mutex);
-            }
-            continue;
+        if (events & EVENT_REQUEST) {
+            drain_commands(&state, &ctx);
         }
-        
-        // Нормальная работа FSM
-        pthread_mutex_lock(&shared_data.mutex);
-        shared_data.current_state = next_state;
-        print_lights(shared_data.current_state);
-        
-        // Если вышли из режима ЧС, сбрасываем все запросы
-        if (was_in_emergency) {
-            reset_pedestrian_requests();
-            was_in_emergency = 0;
-        }
-        pthread_mutex_unlock(&shared_data.mutex);
-        
-        timer_expired = 0;
-        int timer_duration = 1; // По умолчанию
-        
-        // Логика конечного автомата
-        switch (next_state) {
-            case STATE_ALL_RED:
-                timer_duration = ALL_RED_DURATION;
-                // Проверяем запросы пешеходов перед выбором следующего состояния
-                pthread_mutex_lock(&shared_data.mutex);
-                if (check_pedestrian_requests()) {
-                    next_state = STATE_PED_CROSS;
-                } else {
-                    next_state = STATE_NS_GREEN;
+        if (events & EVENT_TIMER) {
+            // Срабатывание может быть ранним (раскладка старшего уровня колеса),
+            // а перевзведенный командой таймер колесо просто не выдаст
+            int32_t fired[TIMER_COUNT];
+            int count;
+            while ((count = wheel_expire(&controller_timers, wheel_current_tick(&controller_timers),
+                                         fired, TIMER_COUNT)) > 0) {
+                for (int i = 0; i < count; ++i) {
+                    if (fired[i] == TIMER_STATE) controller_step(&state, EV_TIMER, &ctx);
                 }
-                pthread_mutex_unlock(&shared_data.mutex);
-                break;
-                
-            case STATE_NS_GREEN:
-                timer_duration = GREEN_DURATION;
-                next_state = STATE_NS_YELLOW;
-                break;
-                
-            case STATE_NS_YELLOW:
-                timer_duration = YELLOW_DURATION;
-                next_state = STATE_ALL_RED;
-                break;
-                
-            case STATE_EW_GREEN:
-                timer_duration = GREEN_DURATION;
-                next_state = STATE_EW_YELLOW;
-                break;
-                
-            case STATE_EW_YELLOW:
-                timer_duration = YELLOW_DURATION;
-                next_state = STATE_ALL_RED;
-                break;
-                
-            case STATE_PED_CROSS:
-                timer_duration = PED_CROSS_DURATION;
-                pthread_mutex_lock(&shared_data.mutex);
-                reset_pedestrian_requests();
-                pthread_mutex_unlock(&shared_data.mutex);
-                
-                // После пешеходного перехода возвращаемся к нормальному циклу
-                next_state = STATE_ALL_RED;
-                break;
-                
-            case STATE_EMERGENCY:
-                timer_duration = 1;
-                next_state = STATE_EMERGENCY;
-                break;
-                
-            default:
-                timer_duration = 1;
-                next_state = STATE_ALL_RED;
-                break;
-        }
-        
-        // Взводим таймер
-        set_timer(timer_duration);
-        
-        // Ожидаем истечения таймера с возможностью прерывания
-        while (!timer_expired && program_running) {
-            // Проверяем режим ЧС каждые 100ms
-            usleep(100000);
-            
-            pthread_mutex_lock(&shared_data.mutex);
-            if (shared_data.emergency_request) {
-                // Немедленный переход в режим ЧС
-                emergency_active = 1;
-                shared_data.emergency_request = 0;
-                timer_expired = 1; // Прерываем ожидание
             }
-            pthread_mutex_unlock(&shared_data.mutex);
+            program_tick_source();
         }
     }
     
     return NULL;
 }
 
+// Передать команду контроллеру; 1 при успехе
+static int send_command(Command command) {
+    if (command_queue_push(&shared_data.commands, command) == -1) {
+        printf("Очередь команд переполнена, команда отброшена\n");
+        return 0;
+    }
+    return 1;
+}
+
 // Функция потока для пользовательского ввода
 void* input_thread_func(void* arg) {
+    (void)arg;
     printf("\n=== Управление перекрестком ===\n");
     printf("Клавиши управления:\n");
     printf("  n - Запрос пешехода Север-Юг\n");
@@ -249,35 +181,39 @@ void* input_thread_func(void* arg) {
     printf("  q - Выход из программы\n");
     
     while (program_running) {
-        char c = getchar();
+        int c = getchar();
         
-        if (c == 'q' || c == 'Q') {
+        if (c == 'q' || c == 'Q' || c == EOF) {
             program_running = 0;
+            events_notify(&controller_events);
             break;
         }
         
-        pthread_mutex_lock(&shared_data.mutex);
+        // Состояние опубликовано контроллером атомарно, мьютекс не нужен
+        int emergency_active = atomic_load_explicit(&shared_data.current_state,
+                                                    memory_order_acquire) == STATE_EMERGENCY;
+        int sent = 0;
         
         switch (c) {
             case 'n':
             case 'N':
-                if (!emergency_active) {
-                    shared_data.ped_ns_request = 1;
+                if (!emergency_active && (sent = send_command(CMD_PED_NS))) {
                     printf("Запрос пешехода Север-Юг зарегистрирован\n");
                 }
                 break;
                 
             case 'e':
             case 'E':
-                if (!emergency_active) {
-                    shared_data.ped_ew_request = 1;
+                if (!emergency_active && (sent = send_command(CMD_PED_EW))) {
                     printf("Запрос пешехода Запад-Восток зарегистрирован\n");
                 }
                 break;
                 
             case 's':
             case 'S':
-                shared_data.emergency_request = 1;
+                if (!(sent = send_command(CMD_EMERGENCY))) {
+                    break;
+                }
                 if (emergency_active) {
                     printf("Режим ЧС отключен\n");
                 } else {
@@ -295,7 +231,10 @@ void* input_thread_func(void* arg) {
                 break;
         }
         
-        pthread_mutex_unlock(&shared_data.mutex);
+        // Разбудить контроллер: он сам решит, нужна ли реакция сейчас
+        if (sent) {
+            events_notify(&controller_events);
+        }
         
         // Очищаем буфер ввода
         if (c != '\n' && c != EOF) {
@@ -309,9 +248,8 @@ void* input_thread_func(void* arg) {
 
 int main() {
     // Инициализация разделяемых данных
-    memset(&shared_data, 0, sizeof(SharedData));
-    pthread_mutex_init(&shared_data.mutex, NULL);
-    shared_data.current_state = STATE_INIT;
+    atomic_init(&shared_data.current_state, STATE_INIT);
+    command_queue_init(&shared_data.commands);
     
     // Настройка обработчика Ctrl+C
     struct sigaction sa_int;
@@ -320,21 +258,20 @@ int main() {
     sa_int.sa_flags = 0;
     sigaction(SIGINT, &sa_int, NULL);
     
-    // Настройка обработчика сигнала для таймера
-    struct sigaction sa;
-    sa.sa_handler = timer_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    sigaction(SIGRTMIN, &sa, NULL);
-    
-    // Создание POSIX таймера
-    struct sigevent sev;
-    sev.sigev_notify = SIGEV_SIGNAL;
-    sev.sigev_signo = SIGRTMIN;
-    sev.sigev_value.sival_ptr = &timer;
-    
-    if (timer_create(CLOCK_REALTIME, &sev, &timer) == -1) {
-        perror("timer_create failed");
+    // Источник событий: timerfd тикает колесо таймеров, eventfd несет запросы
+    if (events_init(&controller_events) == -1) {
+        perror("events_init failed");
+        return 1;
+    }
+    if (wheel_init(&controller_timers, TIMER_COUNT, CONTROLLER_TICK_NS) == -1) {
+        perror("wheel_init failed");
+        events_destroy(&controller_events);
+        return 1;
+    }
+    if (fsm_compile(&intersection_table, &intersection) == -1) {
+        printf("Таблица переходов не помещается в ограничения FSM\n");
+        wheel_destroy(&controller_timers);
+        events_destroy(&controller_events);
         return 1;
     }
     
@@ -360,9 +297,9 @@ int main() {
     // Завершение работы
     printf("\nЗавершение работы системы...\n");
     
-    // Уничтожение мьютекса и таймера
-    pthread_mutex_destroy(&shared_data.mutex);
-    timer_delete(timer);
+    // Уничтожение таймеров и источника событий
+    wheel_destroy(&controller_timers);
+    events_destroy(&controller_events);
     
     printf("Система остановлена корректно.\n");
     